@@ -3,34 +3,40 @@
 
 bintree::bintree()
 {
-	root = NULL;
+	root = NO_NODE;
 	_count = 0;
 }
 
 bintree::~bintree()
 {
-	delete_tree(root);
+	// the pool frees itself
+}
 
-	_count = 0;
+void bintree::reserve(size_t count)
+{
+	// with the final size known up front the pool never has to move
+	_pool.reserve(count);
 }
 
-void bintree::delete_tree()
+uint32_t bintree::allocate(int value)
 {
-	delete_tree(root);
+	node n;
+	n.value = value;
+	n.left = NO_NODE;
+	n.right = NO_NODE;
 
-	_count = 0;
+	_pool.push_back(n);
+
+	return (uint32_t)(_pool.size() - 1);
 }
 
-void bintree::delete_tree(node *n)
+void bintree::delete_tree()
 {
-	if (NULL != n)
-	{
-		delete_tree(n->left);
-		delete_tree(n->right);
-		 
-		n = NULL;
-		delete n;
-	}
+	// all nodes are in one block, so this is one free no matter how big the tree is
+	std::vector<node>().swap(_pool);
+
+	root = NO_NODE;
+	_count = 0;
 }
 
 int bintree::getCount()
@@ -40,77 +46,58 @@ int bintree::getCount()
 
 void bintree::insert(int value)
 {
-	if (NULL == root)
+	if (NO_NODE == root)
 	{
-		root = new node;
-		root->value = value;
-		root->left = NULL;
-		root->right = NULL;
+		root = allocate(value);
 	}
 	else
 	{
-		insert(value, root);
-	}
+		// walk down randomly until there is a free place (one rand() per level, like before)
+		uint32_t current = root;
 
-	_count++;
-}
+		while (true)
+		{
+			int val = rand() % 10000;
+			uint32_t next = (val < 5000) ? _pool[current].left : _pool[current].right;
 
-void bintree::insert(int value, node *n)
-{
-	int val = rand() % 10000;
+			if (NO_NODE == next)
+			{
+				uint32_t created = allocate(value);	// (may move the pool, so no references across this)
 
-	if (val < 5000)
-	{
-		if (NULL != n->left)
-		{
-			insert(value, n->left);
-		}
-		else
-		{
-			n->left = new node;
-			n->left->value = value;
-			n->left->left = NULL;
-			n->left->right = NULL;
-		}
-	}
-	else
-	{
-		if (NULL != n->right)
-		{
-			insert(value, n->right);
-		}
-		else
-		{
-			n->right = new node;
-			n->right->value = value;
-			n->right->left = NULL;
-			n->right->right = NULL;
+				if (val < 5000) _pool[current].left = created;
+				else _pool[current].right = created;
+
+				break;
+			}
+
+			current = next;
 		}
 	}
+
+	_count++;
 }
 
 /*
 bool bintree::search(int value)
 {
-	return search(value, root);
-}
+	uint32_t current = root;
 
-bool bintree::search(int value, node *n)
-{
-	if (n == NULL)
-	{
-		return false;
-	}
-	else
+	while (NO_NODE != current)
 	{
-		if (value == n->value) return true;
-		if (value < n->value) return search(value, n->left);
-		else return search(value, n->right);
+		if (value == _pool[current].value) return true;
+		current = (value < _pool[current].value) ? _pool[current].left : _pool[current].right;
 	}
+
+	return false;
 }
 */
 
-node bintree::getRoot()
+uint32_t bintree::getRoot() const
 {
-	return *root;
-}
\ No newline at end of file
+	return root;
+}
+
+const node &bintree::getNode(uint32_t index) const
+{
+	return _pool[index];
+}
@@ -2,30 +2,34 @@
 
 #include "node.h"
 #include <vector>
+#include <cstddef>
 
 class bintree
 {
 private:
 
-	void insert(int value, node *n);
-	//bool search(int value, node *n);
+	std::vector<node> _pool;	// every node of the tree, children are indices into this
 
-	void delete_tree(node *n);
+	uint32_t allocate(int value);
 
 	int _count;
 
-	node *root;
+	uint32_t root;
 
 public:
 	bintree();
 	~bintree();
 
+	void reserve(size_t count);
+
 	void insert(int value);
 	//bool search(int value);
 
 	void delete_tree();
 
-	node getRoot();
+	uint32_t getRoot() const;
+
+	const node &getNode(uint32_t index) const;
 
 	int getCount();
 };
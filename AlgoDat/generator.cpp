@@ -0,0 +1,450 @@
+#include "generator.h"
+#include <cmath>
+#include <thread>
+#include <system_error>
+#include <queue>
+#include <new>
+
+#define STREAM_SPLIT 1		// independent random streams, so changing one topology does not change the others
+#define STREAM_DISTANCE 2
+#define STREAM_SAVEHOUSE 3
+#define STREAM_RMAT 4
+
+#define CHUNK_SIZE (1 << 18)	// nodes/edges one thread turns into text at once (a few MiB)
+
+static uint64_t mix(uint64_t z)
+{
+	// splitmix64 finalizer, every counter gives an independent looking number
+	z += 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+generator::generator(uint64_t nodes, int distanceMode, uint64_t seed, unsigned threads, topology shape, uint64_t edgeFactor)
+{
+	_nodes = nodes;
+	_distanceMode = distanceMode;
+	_seed = seed;
+	_threads = (threads > 0) ? threads : 1;
+	_topology = shape;
+	_edgeFactor = edgeFactor;
+	_filtered = false;
+
+	_columns = (uint64_t)std::sqrt((double)nodes);
+	while (_columns * _columns < nodes) _columns++;
+
+	_scale = 1;
+	while (_scale < 63 && ((uint64_t)1 << _scale) < nodes) _scale++;
+
+	if (TOPOLOGY_TREE == _topology) planTree();
+}
+
+uint64_t generator::random(uint64_t stream, uint64_t counter) const
+{
+	// counter based: the number only depends on seed, stream and counter, not on which thread asks first
+	return mix(mix(_seed ^ (stream * 0xD6E8FEB86659FD93ULL)) + counter);
+}
+
+uint64_t generator::distance(uint64_t key) const
+{
+	if (_distanceMode == 0) return 1;					// all reachable
+	if (_distanceMode == 1) return _nodes - 1;			// nothing reachable
+	return random(STREAM_DISTANCE, key) % _nodes;		// all random
+}
+
+void generator::appendEdge(std::string &out, uint64_t from, uint64_t to, uint64_t key, bool binary) const
+{
+	writer::appendEdge(out, from, to, distance(key), binary);
+}
+
+uint64_t generator::getStartID() const
+{
+	return 0;
+}
+
+uint64_t generator::getEndID() const
+{
+	// the trees have the nodes 0 to n - 2 and the sink n (like the old generator)
+	return (TOPOLOGY_TREE == _topology || TOPOLOGY_BINTREE == _topology) ? _nodes : _nodes - 1;
+}
+
+uint64_t generator::getDistance() const
+{
+	return _nodes + 1;
+}
+
+uint64_t generator::getNodeCount() const
+{
+	// how many ids (from 0) can be savehouses
+	return (TOPOLOGY_TREE == _topology || TOPOLOGY_BINTREE == _topology) ? _nodes - 1 : _nodes;
+}
+
+bool generator::isSaveHouse(uint64_t id) const
+{
+	return random(STREAM_SAVEHOUSE, id) % 10000 > 9500;
+}
+
+bool generator::isExpected(uint64_t id) const
+{
+	return isSaveHouse(id) && (!_filtered || (_expected[id >> 6] >> (id & 63)) & 1);
+}
+
+uint64_t generator::getEdgeCount() const
+{
+	switch (_topology)
+	{
+	case TOPOLOGY_TREE:
+	case TOPOLOGY_BINTREE:
+		return 2 * _nodes;	// n - 2 tree edges and at most n - 1 leaves
+	case TOPOLOGY_GRID:
+		return 4 * _nodes;
+	case TOPOLOGY_RMAT:
+		return _nodes * _edgeFactor;
+	case TOPOLOGY_CHAIN:
+	default:
+		return _nodes - 1;
+	}
+}
+
+bool generator::needsSearches() const
+{
+	// with distance 1 the tree, the grid and the chain have every node on a route of at most n edges (n + 1 is the limit),
+	// everything else needs the searches
+	return _distanceMode != 0 || TOPOLOGY_RMAT == _topology;
+}
+
+bool generator::findExpected()
+{
+	if (!needsSearches()) return true;
+
+	try
+	{
+		_expected = findOnRoute(getEndID() + 1, getStartID(), getEndID(), getDistance(), [this](const edgeSink &sink) { forEachEdge(sink); });
+		_expected.resize((getEndID() + 64) / 64, 0);	// (the empty result has no bits)
+		_filtered = true;
+	}
+	catch (const std::bad_alloc &)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void generator::planTree()
+{
+	// the tree is split at random (left gets 0 to size - 1 nodes), the nodes of a subtree are numbered root, left, right.
+	// the top of the tree is split here until every subtree is small enough to be one task
+	std::vector<task> pending(1, task{ 0, _nodes - 1 });
+
+	while (!pending.empty())
+	{
+		task current = pending.back();
+		pending.pop_back();
+
+		if (current.count <= CHUNK_SIZE)
+		{
+			_tasks.push_back(current);
+			continue;
+		}
+
+		uint64_t left = random(STREAM_SPLIT, current.first) % current.count;
+		uint64_t right = current.count - 1 - left;
+
+		if (right > 0)
+		{
+			_prefix.push_back(task{ current.first, current.first + 1 + left });
+			pending.push_back(task{ current.first + 1 + left, right });
+		}
+
+		if (left > 0)
+		{
+			_prefix.push_back(task{ current.first, current.first + 1 });
+			pending.push_back(task{ current.first + 1, left });
+		}
+	}
+}
+
+template <typename Sink> void generator::visitSubtree(const task &subtree, Sink &&edge) const
+{
+	// the same splitting as planTree with an explicit stack, the key of a tree edge is the child (it has only one parent)
+	std::vector<task> stack(1, subtree);
+
+	while (!stack.empty())
+	{
+		task current = stack.back();
+		stack.pop_back();
+
+		if (current.count == 1)
+		{
+			edge(current.first, _nodes, _nodes + current.first);	// leaf to the sink
+			continue;
+		}
+
+		uint64_t left = random(STREAM_SPLIT, current.first) % current.count;
+		uint64_t right = current.count - 1 - left;
+
+		if (left > 0) edge(current.first, current.first + 1, current.first + 1);
+		if (right > 0) edge(current.first, current.first + 1 + left, current.first + 1 + left);
+
+		if (right > 0) stack.push_back(task{ current.first + 1 + left, right });
+		if (left > 0) stack.push_back(task{ current.first + 1, left });
+	}
+}
+
+template <typename Sink> void generator::visitGrid(uint64_t first, uint64_t last, Sink &&edge) const
+{
+	for (uint64_t i = first; i < last; i++)
+	{
+		uint64_t column = i % _columns;
+
+		if (column + 1 < _columns && i + 1 < _nodes) edge(i, i + 1, 4 * i);
+		if (column > 0) edge(i, i - 1, 4 * i + 1);
+		if (i + _columns < _nodes) edge(i, i + _columns, 4 * i + 2);
+		if (i >= _columns) edge(i, i - _columns, 4 * i + 3);
+	}
+}
+
+template <typename Sink> void generator::visitRmat(uint64_t first, uint64_t last, Sink &&edge) const
+{
+	// every level picks a quadrant with a = 0.57, b = 0.19, c = 0.19, d = 0.05 (16 bits per level)
+	const uint64_t a = 37355, b = a + 12452, c = b + 12452;
+
+	for (uint64_t index = first; index < last; index++)
+	{
+		uint64_t from = 0, to = 0, bits = 0;
+
+		for (uint32_t level = 0; level < _scale; level++)
+		{
+			if (0 == (level & 3)) bits = random(STREAM_RMAT, index * 16 + level / 4);
+
+			uint64_t value = bits & 0xFFFF;
+			bits >>= 16;
+
+			from = (from << 1) | (value >= b);
+			to = (to << 1) | ((value >= a && value < b) || value >= c);
+		}
+
+		edge(from % _nodes, to % _nodes, index);
+	}
+}
+
+void generator::forEachEdge(const edgeSink &sink) const
+{
+	// the same edges in the same order as writeEdges
+	auto edge = [this, &sink](uint64_t from, uint64_t to, uint64_t key) { sink(from, to, distance(key)); };
+
+	switch (_topology)
+	{
+	case TOPOLOGY_TREE:
+		for (const task &prefix : _prefix) sink(prefix.first, prefix.count, distance(prefix.count));
+		for (const task &subtree : _tasks) visitSubtree(subtree, edge);
+		break;
+	case TOPOLOGY_GRID:
+		visitGrid(0, _nodes, edge);
+		break;
+	case TOPOLOGY_RMAT:
+		visitRmat(0, _nodes * _edgeFactor, edge);
+		break;
+	case TOPOLOGY_CHAIN:
+	default:
+		for (uint64_t i = 0; i + 1 < _nodes; i++) edge(i, i + 1, i);
+		break;
+	}
+}
+
+bool generator::writeParallel(writer &output, writer *copy, bool separate, uint64_t chunks, const chunkWriter &make) const
+{
+	// _threads chunks are made at the same time, then handed to the writers in order, so the file does not depend on the thread count.
+	// the writer threads write one round while the next one is made
+	std::vector<std::string> buffers(_threads), copies(_threads);
+
+	for (uint64_t first = 0; first < chunks; first += _threads)
+	{
+		uint64_t count = (chunks - first < _threads) ? chunks - first : _threads;
+		std::vector<std::thread> workers;
+
+		for (uint64_t i = 0; i < count; i++)
+		{
+			buffers[i].clear();
+			copies[i].clear();
+		}
+
+		for (uint64_t i = 1; i < count; i++)
+		{
+			try
+			{
+				workers.emplace_back([&make, &buffers, &copies, first, i]() { make(first + i, buffers[i], copies[i]); });
+			}
+			catch (const std::system_error &)
+			{
+				make(first + i, buffers[i], copies[i]);	// no thread, do it here
+			}
+		}
+
+		make(first, buffers[0], copies[0]);
+
+		for (std::thread &worker : workers) worker.join();
+
+		for (uint64_t i = 0; i < count; i++)
+		{
+			if (NULL != copy)
+			{
+				if (!separate) copy->write(buffers[i]);	// the same bytes as the output
+				else copy->writeBlock(copies[i]);
+			}
+
+			output.writeBlock(buffers[i]);	// the writer gives an empty one back
+		}
+
+		if (output.hasFailed() || (NULL != copy && copy->hasFailed())) return false;
+	}
+
+	return true;
+}
+
+bool generator::writeEdges(writer &output) const
+{
+	bool binary = output.isBinary();
+
+	switch (_topology)
+	{
+	case TOPOLOGY_TREE:
+		for (const task &edge : _prefix) output.writeEdge(edge.first, edge.count, distance(edge.count));	// key is the child, like in writeSubtree
+
+		return writeParallel(output, NULL, false, _tasks.size(), [this, binary](uint64_t chunk, std::string &out, std::string &)
+		{
+			visitSubtree(_tasks[chunk], [this, &out, binary](uint64_t from, uint64_t to, uint64_t key) { appendEdge(out, from, to, key, binary); });
+		});
+	case TOPOLOGY_GRID:
+		return writeParallel(output, NULL, false, (_nodes + CHUNK_SIZE - 1) / CHUNK_SIZE, [this, binary](uint64_t chunk, std::string &out, std::string &)
+		{
+			uint64_t first = chunk * CHUNK_SIZE;
+			visitGrid(first, (_nodes - first < CHUNK_SIZE) ? _nodes : first + CHUNK_SIZE,
+				[this, &out, binary](uint64_t from, uint64_t to, uint64_t key) { appendEdge(out, from, to, key, binary); });
+		});
+	case TOPOLOGY_RMAT:
+		return writeParallel(output, NULL, false, (_nodes * _edgeFactor + CHUNK_SIZE - 1) / CHUNK_SIZE, [this, binary](uint64_t chunk, std::string &out, std::string &)
+		{
+			uint64_t first = chunk * CHUNK_SIZE, edges = _nodes * _edgeFactor;
+			visitRmat(first, (edges - first < CHUNK_SIZE) ? edges : first + CHUNK_SIZE,
+				[this, &out, binary](uint64_t from, uint64_t to, uint64_t key) { appendEdge(out, from, to, key, binary); });
+		});
+	case TOPOLOGY_CHAIN:
+	default:
+		return writeParallel(output, NULL, false, (_nodes - 1 + CHUNK_SIZE - 1) / CHUNK_SIZE, [this, binary](uint64_t chunk, std::string &out, std::string &)
+		{
+			uint64_t first = chunk * CHUNK_SIZE, last = (_nodes - 1 - first < CHUNK_SIZE) ? _nodes - 1 : first + CHUNK_SIZE;
+			for (uint64_t i = first; i < last; i++) appendEdge(out, i, i + 1, i, binary);
+		});
+	}
+}
+
+bool generator::writeSaveHouses(writer &output, writer *expected) const
+{
+	// in order of the ids, so the expected output (always text) is sorted like the one of the solver. it is the same bytes as
+	// the input if that is text and every savehouse is on a route
+	uint64_t count = getNodeCount();
+	bool binary = output.isBinary(), separate = NULL != expected && (binary || _filtered);
+
+	return writeParallel(output, expected, separate, (count + CHUNK_SIZE - 1) / CHUNK_SIZE, [this, count, binary, separate](uint64_t chunk, std::string &out, std::string &copy)
+	{
+		uint64_t first = chunk * CHUNK_SIZE, last = (count - first < CHUNK_SIZE) ? count : first + CHUNK_SIZE;
+
+		for (uint64_t i = first; i < last; i++)
+		{
+			if (isSaveHouse(i))
+			{
+				writer::appendSaveHouse(out, i, binary);
+				if (separate && isExpected(i)) writer::appendSaveHouse(copy, i, false);
+			}
+		}
+	});
+}
+
+std::vector<uint64_t> findOnRoute(uint64_t ids, uint64_t start, uint64_t end, uint64_t limit, const std::function<void(const edgeSink &)> &forEach)
+{
+	// dijkstra from start on the edges and from end on the reversed ones, the edges of both directions in one array each
+	// (offsets[1 + node] is where the edges of node go, after filling it is where the ones of the next node start)
+	std::vector<uint64_t> offsets[2] = { std::vector<uint64_t>(ids + 2, 0), std::vector<uint64_t>(ids + 2, 0) };
+
+	forEach([&offsets](uint64_t from, uint64_t to, uint64_t)
+	{
+		offsets[0][from + 2]++;
+		offsets[1][to + 2]++;
+	});
+
+	for (uint64_t i = 2; i < ids + 2; i++)
+	{
+		offsets[0][i] += offsets[0][i - 1];
+		offsets[1][i] += offsets[1][i - 1];
+	}
+
+	struct arc
+	{
+		uint32_t node;		// ids are below MAX_ID
+		uint32_t distance;	// so is the limit, a longer edge is never used
+	};
+
+	std::vector<arc> arcs[2] = { std::vector<arc>(offsets[0][ids + 1]), std::vector<arc>(offsets[1][ids + 1]) };
+
+	forEach([&offsets, &arcs, limit](uint64_t from, uint64_t to, uint64_t distance)
+	{
+		uint32_t weight = (distance > limit) ? (uint32_t)(limit + 1) : (uint32_t)distance;
+
+		arcs[0][offsets[0][from + 1]++] = arc{ (uint32_t)to, weight };
+		arcs[1][offsets[1][to + 1]++] = arc{ (uint32_t)from, weight };
+	});
+
+	std::vector<uint64_t> result;
+
+	// a node without edges is not in the graph of the solver, not even as start or end
+	for (uint64_t node : { start, end })
+	{
+		if (offsets[0][node] == offsets[0][node + 1] && offsets[1][node] == offsets[1][node + 1]) return result;
+	}
+
+	std::vector<uint64_t> distances[2];
+	typedef std::pair<uint64_t, uint64_t> entry;	// distance, node
+
+	for (int direction = 0; direction < 2; direction++)
+	{
+		std::vector<uint64_t> &distance = distances[direction];
+		std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+		uint64_t source = (0 == direction) ? start : end;
+
+		distance.assign(ids, UINT64_MAX);
+		distance[source] = 0;
+		queue.push(entry(0, source));
+
+		while (!queue.empty())
+		{
+			entry current = queue.top();
+			queue.pop();
+
+			if (current.first > distance[current.second]) continue;	// an old entry
+
+			for (uint64_t i = offsets[direction][current.second]; i < offsets[direction][current.second + 1]; i++)
+			{
+				uint64_t next = arcs[direction][i].node, length = current.first + arcs[direction][i].distance;
+
+				if (length <= limit && length < distance[next])
+				{
+					distance[next] = length;
+					queue.push(entry(length, next));
+				}
+			}
+		}
+	}
+
+	result.assign((ids + 63) / 64, 0);
+
+	for (uint64_t i = 0; i < ids; i++)
+	{
+		if (distances[0][i] <= limit && distances[1][i] <= limit) result[i >> 6] |= (uint64_t)1 << (i & 63);
+	}
+
+	return result;
+}
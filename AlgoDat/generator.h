@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "writer.h"
+
+typedef std::function<void(uint64_t, uint64_t, uint64_t)> edgeSink;	// from, to, distance
+
+// one bit per id for the nodes that are at most limit away from start and at most limit away from end (what the solver
+// looks for), forEach hands every edge to the sink and is called twice. empty if start or end have no edges
+std::vector<uint64_t> findOnRoute(uint64_t ids, uint64_t start, uint64_t end, uint64_t limit, const std::function<void(const edgeSink &)> &forEach);
+
+enum topology
+{
+	TOPOLOGY_TREE,		// random binary tree, leaves lead to a sink (streamed)
+	TOPOLOGY_BINTREE,	// the same through bintree (the old generator, single threaded)
+	TOPOLOGY_GRID,		// 4-neighbour grid
+	TOPOLOGY_RMAT,		// R-MAT power law graph
+	TOPOLOGY_CHAIN		// one long path
+};
+
+class generator
+{
+private:
+	struct task
+	{
+		uint64_t first;	// tree: root of a subtree, otherwise first node/edge
+		uint64_t count;	// tree: nodes in the subtree, otherwise how many nodes/edges
+	};
+
+	typedef std::function<void(uint64_t, std::string &, std::string &)> chunkWriter;	// chunk, output, copy (if it is separate)
+
+	uint64_t _nodes;
+	int _distanceMode;
+	uint64_t _seed;
+	unsigned _threads;
+	topology _topology;
+	uint64_t _edgeFactor;
+	uint64_t _columns;
+	uint32_t _scale;
+
+	std::vector<task> _tasks;	// the subtrees the tree is split into
+	std::vector<task> _prefix;	// edges of the nodes above those subtrees (first is the parent, count the child)
+	std::vector<uint64_t> _expected;	// bit per id: the savehouses the solver finds (empty: all of them)
+	bool _filtered;
+
+	uint64_t random(uint64_t stream, uint64_t counter) const;
+	uint64_t distance(uint64_t key) const;
+	void appendEdge(std::string &out, uint64_t from, uint64_t to, uint64_t key, bool binary) const;
+
+	void planTree();
+	template <typename Sink> void visitSubtree(const task &subtree, Sink &&edge) const;	// edge(from, to, key) for every edge
+	template <typename Sink> void visitGrid(uint64_t first, uint64_t last, Sink &&edge) const;
+	template <typename Sink> void visitRmat(uint64_t first, uint64_t last, Sink &&edge) const;
+	void forEachEdge(const edgeSink &sink) const;	// all of them with their distance, one thread
+
+	bool writeParallel(writer &output, writer *copy, bool separate, uint64_t chunks, const chunkWriter &make) const;
+
+public:
+	generator(uint64_t nodes, int distanceMode, uint64_t seed, unsigned threads, topology shape, uint64_t edgeFactor);
+
+	uint64_t getStartID() const;
+	uint64_t getEndID() const;
+	uint64_t getDistance() const;
+	uint64_t getNodeCount() const;
+	uint64_t getEdgeCount() const;	// (at most)
+
+	bool isSaveHouse(uint64_t id) const;
+	bool isExpected(uint64_t id) const;	// a savehouse on a route from start to end
+
+	bool needsSearches() const;	// false if every savehouse is on a route
+	bool findExpected();	// keeps the whole graph for two searches if needsSearches (about 16 B per edge and 32 per id), false if that does not fit
+
+	bool writeEdges(writer &output) const;
+	bool writeSaveHouses(writer &output, writer *expected) const;	// (without the expected output if that is NULL)
+};
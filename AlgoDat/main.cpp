@@ -1,33 +1,78 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
-#include <ctime>
+#include <cstdio>
+#include <cstring>
 #include <vector>
 #include <string>
+#include <thread>
+#include <memory>
+#include <algorithm>
 
 #include "bintree.h"
+#include "generator.h"
+#include "writer.h"
+
+#define MAX_ID 4000000000ULL	// the solver only takes numbers below this
+#define EXPECTED_EDGE_LIMIT (1ULL << 22)	// bigger graphs only get the expected output with --expected (its searches keep the graph, ~100 MB here)
 
 int main(int argc, char **argv);
-void traverse(node *n, std::ofstream *output);
+int writeBintree(const char *inputPath, const char *expectedPath, uint64_t seed, bool binary);
+void writeEdge(int from, int to, writer *output);
+void traverse(const bintree &tree, writer *output);
 
 int maxNodes = 0;
 int distanceMode = 0;
 
+struct route
+{
+	uint32_t parent;
+	uint32_t distance;	// of the edge from the parent
+	uint32_t fromStart;	// distances in the tree, capped at maxNodes + 2 (longer than the limit)
+	uint32_t toSink;
+};
+
+std::vector<route> routes;	// per value, filled by writeEdge for the expected output (empty with distance mode 0)
+
 int main(int argc, char **argv)
 {
-	if (argc < 5)
+	std::vector<const char*> arguments;
+	uint64_t seed = 1;
+	unsigned threads = std::thread::hardware_concurrency();
+	topology shape = TOPOLOGY_TREE;
+	uint64_t edgeFactor = 16;
+	bool binary = false;
+	bool searchAlways = false;	// find the expected output even if the graph is bigger than EXPECTED_EDGE_LIMIT
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (0 == strncmp(argv[i], "--seed=", 7)) seed = std::strtoull(argv[i] + 7, nullptr, 10);
+		else if (0 == strncmp(argv[i], "--threads=", 10)) threads = (unsigned)std::strtoul(argv[i] + 10, nullptr, 10);
+		else if (0 == strncmp(argv[i], "--edge-factor=", 14)) edgeFactor = std::strtoull(argv[i] + 14, nullptr, 10);
+		else if (0 == strcmp(argv[i], "--binary")) binary = true;
+		else if (0 == strcmp(argv[i], "--expected")) searchAlways = true;
+		else if (0 == strcmp(argv[i], "--topology=tree")) shape = TOPOLOGY_TREE;
+		else if (0 == strcmp(argv[i], "--topology=bintree")) shape = TOPOLOGY_BINTREE;
+		else if (0 == strcmp(argv[i], "--topology=grid")) shape = TOPOLOGY_GRID;
+		else if (0 == strcmp(argv[i], "--topology=rmat")) shape = TOPOLOGY_RMAT;
+		else if (0 == strcmp(argv[i], "--topology=chain")) shape = TOPOLOGY_CHAIN;
+		else arguments.push_back(argv[i]);
+	}
+
+	if (arguments.size() < 4)
 	{
 		std::cerr << "Missing arguments!" << std::endl;
 
-		std::cout << "gc++ <infile> <outfile> <node count> <distance mode>" << std::endl;
+		std::cout << "gc++ <infile> <outfile> <node count> <distance mode> [--seed=N] [--threads=N]" << std::endl
+				  << "     [--topology=tree|bintree|grid|rmat|chain] [--edge-factor=N] [--binary] [--expected]" << std::endl;
 
 		return 0;
 	}
 
-	maxNodes = std::stoi(argv[3], nullptr, 10);
-	distanceMode = std::stoi(argv[4], nullptr, 10);
+	uint64_t nodes = std::stoull(arguments[2], nullptr, 10);
+	distanceMode = std::stoi(arguments[3], nullptr, 10);
 
-	if (distanceMode > 2)
+	if (distanceMode < 0 || distanceMode > 2)
 	{
 		std::cerr << "Valid distance modes are: " << std::endl
 				  << "  0 - all reachable" << std::endl
@@ -36,30 +81,91 @@ int main(int argc, char **argv)
 		return 0;
 	}
 
+	if (nodes < 2 || nodes + 1 >= MAX_ID || 0 == edgeFactor)
+	{
+		std::cerr << "The node count has to be 2 to " << MAX_ID - 2 << "!" << std::endl;
+		return 0;
+	}
+
+	if (TOPOLOGY_BINTREE == shape)
+	{
+		maxNodes = (int)nodes;
+
+		return writeBintree(arguments[0], arguments[1], seed, binary);
+	}
+
+	generator graph(nodes, distanceMode, seed, threads, shape, edgeFactor);
+
+	std::unique_ptr<writer> expected;	// the expected output is what the solver prints
+
+	if (graph.needsSearches() && !searchAlways && graph.getEdgeCount() > EXPECTED_EDGE_LIMIT)
+	{
+		std::cerr << "The expected output needs the whole graph in memory for more than " << EXPECTED_EDGE_LIMIT
+				  << " edges, only the input is written (--expected finds it anyway)!" << std::endl;
+		std::remove(arguments[1]);	// (an old one would not match)
+	}
+	else if (graph.findExpected()) expected.reset(new writer(arguments[1], false));
+	else std::cerr << "Not enough memory to find the expected output, only the input is written!" << std::endl;
+
+	writer output(arguments[0], binary);
+
+	output.writeHeader(graph.getStartID(), graph.getEndID(), graph.getDistance());
+
+	bool written = graph.writeEdges(output);
+
+	output.endEdges();
+
+	if (!written || !graph.writeSaveHouses(output, expected.get()) || !output.close() || (expected && !expected->close()))
+	{
+		std::cerr << "Could not write the output!" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+int writeBintree(const char *inputPath, const char *expectedPath, uint64_t seed, bool binary)
+{
+	// the old generator: one insert after the other into a bintree, then a recursive traverse
 	bintree tree1;
 	std::vector<int> saveHouses;
 
-	srand((unsigned int)time(NULL));
+	srand((unsigned int)seed);
+
+	tree1.reserve((size_t)maxNodes);
 
-	std::ofstream output;
-	output.open(argv[1]);
+	// edges only go from a value to a bigger one or to the sink, so the distances follow from the tree while it is written
+	// (with distance mode 0 every node is on a route of at most maxNodes edges)
+	if (distanceMode != 0) routes.assign((size_t)maxNodes, route{ 0, 0, 0, (uint32_t)maxNodes + 2 });
+
+	writer output(inputPath, binary);
 
 	for (int i = 0; i < (maxNodes - 1); i++)
 	{
 		if (i == 0)
 		{
-			output << "0 " << maxNodes << " " << maxNodes + 1 << std::endl;
+			output.writeHeader(0, (uint64_t)maxNodes, (uint64_t)maxNodes + 1);
 		}
 
 		tree1.insert(i);
-		
+
 		if (rand() % 10000 > 9500)
 		{
 			saveHouses.push_back(i);
 		}
 	}
 
-	traverse(&tree1.getRoot(), &output);
+	traverse(tree1, &output);
+	output.endEdges();
+
+	// a child has a bigger value than its parent, so going down the values every child is done before its parent
+	for (int i = (int)routes.size() - 2; i > 0; i--)
+	{
+		uint64_t distance = (uint64_t)routes[i].distance + routes[i].toSink;
+		route &parent = routes[routes[i].parent];
+
+		if (distance < parent.toSink) parent.toSink = (uint32_t)distance;
+	}
 
 	tree1.delete_tree();
 
@@ -69,63 +175,99 @@ int main(int argc, char **argv)
 	for (int i = 0; i < elements; i++)
 	{
 		int sh = saveHouses.back();
-		output << sh << std::endl;
+		output.writeSaveHouse((uint64_t)sh);
 		saveHouses.pop_back();
 
 		array[i] = sh;
 	}
 
-	output.close();
-	output.open(argv[2]);
+	bool written = output.close();
+
+	writer expected(expectedPath, false);
 
 	qsort(array, elements, sizeof(int), [](const void *a, const void *b) { return *((int*)a) - *((int*)b); });
 
+	// only the savehouses on a route from 0 to the sink (with distance mode 0 that is all of them)
+	uint32_t limit = (uint32_t)maxNodes + 1;
+
 	for (int i = 0; i < elements; i++)
 	{
-		output << array[i] << std::endl;
+		if (routes.empty() || (routes[array[i]].fromStart <= limit && routes[array[i]].toSink <= limit)) expected.writeSaveHouse((uint64_t)array[i]);
 	}
 
-	output.close();
+	written = expected.close() && written;
+
+	free(array);
+	std::vector<route>().swap(routes);
+
+	if (!written)
+	{
+		std::cerr << "Could not write the output!" << std::endl;
+		return 1;
+	}
 
 	return 0;
 }
 
-void traverse(node *n, std::ofstream *output)
+void writeEdge(int from, int to, writer *output)
 {
-	if (NULL == n->left && NULL == n->right)
-	{
-		if(distanceMode == 0)
-			*output << n->value << " " << maxNodes << " 1" << std::endl;
-		else if(distanceMode == 1)
-			*output << n->value << " " << maxNodes << " " << (maxNodes - 1) << std::endl;
-		else
-			*output << n->value << " " << maxNodes << " " << (rand() % maxNodes) << std::endl;
+	int distance;
 
-		return;
-	}
+	if (distanceMode == 0)
+		distance = 1;
+	else if (distanceMode == 1)
+		distance = maxNodes - 1;
+	else
+		distance = rand() % maxNodes;
 
-	if (NULL != n->left)
-	{
-		if (distanceMode == 0)
-			*output << n->value << " " << n->left->value << " 1" << std::endl;
-		else if (distanceMode == 1)
-			*output << n->value << " " << n->left->value << " " << (maxNodes - 1) << std::endl;
-		else
-			*output << n->value << " " << n->left->value << " " << (rand() % maxNodes) << std::endl;
+	output->writeEdge((uint64_t)from, (uint64_t)to, (uint64_t)distance);
 
-		traverse(n->left, output);
-	}
-		
+	if (routes.empty()) return;
+
+	// (traverse writes the edge to a node before the ones from it, every distance is below maxNodes)
+	uint64_t fromStart = std::min<uint64_t>((uint64_t)routes[from].fromStart + (uint64_t)distance, (uint64_t)maxNodes + 2);
+
+	if (to == maxNodes)
+		routes[from].toSink = (uint32_t)distance;
+	else
+		routes[to] = route{ (uint32_t)from, (uint32_t)distance, (uint32_t)fromStart, (uint32_t)maxNodes + 2 };
+}
+
+void traverse(const bintree &tree, writer *output)
+{
+	// preorder with an explicit stack of (parent, child): edge to the left child, its subtree, edge to the right child, its subtree
+	std::vector<uint32_t> stack;
+	uint32_t current = tree.getRoot();
 
-	if (NULL != n->right)
+	while (NO_NODE != current)
 	{
-		if (distanceMode == 0)
-			*output << n->value << " " << n->right->value << " 1" << std::endl;
-		else if (distanceMode == 1)
-			*output << n->value << " " << n->right->value << " " << (maxNodes - 1) << std::endl;
+		const node &n = tree.getNode(current);
+
+		if (NO_NODE == n.left && NO_NODE == n.right)
+		{
+			writeEdge(n.value, maxNodes, output);
+		}
 		else
-			*output << n->value << " " << n->right->value << " " << (rand() % maxNodes) << std::endl;
+		{
+			if (NO_NODE != n.right)
+			{
+				stack.push_back(current);
+				stack.push_back(n.right);
+			}
+
+			if (NO_NODE != n.left)
+			{
+				stack.push_back(current);
+				stack.push_back(n.left);
+			}
+		}
+
+		if (stack.empty()) break;
 
-		traverse(n->right, output);
+		current = stack.back();
+		stack.pop_back();
+
+		writeEdge(tree.getNode(stack.back()).value, tree.getNode(current).value, output);
+		stack.pop_back();
 	}
-}
\ No newline at end of file
+}
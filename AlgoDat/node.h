@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstdint>
+
+#define NO_NODE UINT32_MAX	// index of a child that does not exist
+
 struct node
 {
 	int value;
-	node *left;
-	node *right;
-};
\ No newline at end of file
+	uint32_t left;	// indices into the pool of the tree, not pointers
+	uint32_t right;
+};
@@ -0,0 +1,224 @@
+#include "writer.h"
+#include <charconv>
+#include <cstring>
+#include <system_error>
+
+#define EDGE_TEXT_SIZE 63	// three numbers of up to 20 digits, two spaces and a newline
+
+writer::writer(const char *path, bool binary)
+	: _file(path, std::ios::binary)
+{
+	_binary = binary;
+	_queued = 0;
+	_closing = false;
+	_failed = !_file;
+	_threaded = false;
+
+	try
+	{
+		_thread = std::thread(&writer::run, this);
+		_threaded = true;
+	}
+	catch (const std::system_error &)
+	{
+		// no thread, submit writes the blocks itself
+	}
+}
+
+writer::~writer()
+{
+	close();
+}
+
+void writer::run()
+{
+	// the caller fills the next block while this writes the ones it handed over, in order
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (true)
+	{
+		_changed.wait(lock, [this]() { return !_full.empty() || _closing; });
+
+		if (_full.empty()) return;	// closing and everything is written
+
+		std::string &block = _full.front();	// stays valid, the caller only adds at the back
+
+		lock.unlock();
+		_file.write(block.data(), (std::streamsize)block.size());
+		bool good = (bool)_file;
+		lock.lock();
+
+		if (!good) _failed = true;
+
+		_queued -= block.size();
+		block.clear();
+		_spare.push_back(std::move(block));
+		_full.pop_front();
+
+		_changed.notify_all();
+	}
+}
+
+void writer::submit(std::string &block)
+{
+	// hands the block to the thread and gives the caller an old one (with its memory) back
+	if (block.empty()) return;
+
+	if (!_threaded)
+	{
+		_file.write(block.data(), (std::streamsize)block.size());
+		if (!_file) _failed = true;
+		block.clear();
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	_changed.wait(lock, [this]() { return _queued < WRITE_QUEUE_SIZE || _failed; });	// the disk is slower than we are
+
+	_queued += block.size();
+	_full.push_back(std::move(block));
+	block = std::string();
+
+	if (!_spare.empty())
+	{
+		block = std::move(_spare.back());
+		_spare.pop_back();
+	}
+
+	_changed.notify_all();
+}
+
+bool writer::isBinary() const
+{
+	return _binary;
+}
+
+bool writer::hasFailed()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return _failed;
+}
+
+void writer::writeHeader(uint64_t start, uint64_t end, uint64_t distance)
+{
+	if (_binary)
+	{
+		uint32_t fields[6] = { EDGES_VERSION, EDGES_BYTE_ORDER, (uint32_t)start, (uint32_t)end, (uint32_t)distance, 0 };
+
+		_current.append(EDGES_MAGIC, sizeof(EDGES_MAGIC));
+		_current.append((const char*)fields, sizeof(fields));
+	}
+	else
+	{
+		appendEdge(_current, start, end, distance, false);	// the same three numbers as an edge
+	}
+}
+
+void writer::writeEdge(uint64_t from, uint64_t to, uint64_t distance)
+{
+	appendEdge(_current, from, to, distance, _binary);
+
+	if (_current.size() >= WRITE_BLOCK_SIZE) submit(_current);
+}
+
+void writer::endEdges()
+{
+	// in the text the first line with a single number is the first savehouse, the binary records need a marker
+	if (_binary) appendEdge(_current, EDGES_END, EDGES_END, EDGES_END, true);
+}
+
+void writer::writeSaveHouse(uint64_t id)
+{
+	appendSaveHouse(_current, id, _binary);
+
+	if (_current.size() >= WRITE_BLOCK_SIZE) submit(_current);
+}
+
+void writer::write(const std::string &data)
+{
+	_current.append(data);
+
+	if (_current.size() >= WRITE_BLOCK_SIZE) submit(_current);
+}
+
+void writer::writeBlock(std::string &block)
+{
+	// a block somebody else filled (a whole chunk of the generator), it goes to the thread as it is
+	submit(_current);
+	submit(block);
+}
+
+bool writer::close()
+{
+	submit(_current);
+
+	if (_threaded)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_closing = true;
+		}
+
+		_changed.notify_all();
+		_thread.join();
+		_threaded = false;
+	}
+
+	if (_file.is_open())
+	{
+		_file.close();
+		if (!_file) _failed = true;
+	}
+
+	return !_failed;
+}
+
+void writer::appendNumber(std::string &out, uint64_t value)
+{
+	char digits[20];
+	std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+
+	out.append(digits, (size_t)(result.ptr - digits));
+}
+
+void writer::appendEdge(std::string &out, uint64_t from, uint64_t to, uint64_t distance, bool binary)
+{
+	if (binary)
+	{
+		uint32_t record[3] = { (uint32_t)from, (uint32_t)to, (uint32_t)distance };	// every number is < 2^32
+
+		out.append((const char*)record, sizeof(record));
+		return;
+	}
+
+	// the digits go straight into the string, one resize per line instead of one append per number
+	size_t size = out.size();
+	out.resize(size + EDGE_TEXT_SIZE);
+
+	char *cursor = &out[size], *end = cursor + EDGE_TEXT_SIZE;
+
+	cursor = std::to_chars(cursor, end, from).ptr;
+	*cursor++ = ' ';
+	cursor = std::to_chars(cursor, end, to).ptr;
+	*cursor++ = ' ';
+	cursor = std::to_chars(cursor, end, distance).ptr;
+	*cursor++ = '\n';
+
+	out.resize((size_t)(cursor - out.data()));
+}
+
+void writer::appendSaveHouse(std::string &out, uint64_t id, bool binary)
+{
+	if (binary)
+	{
+		uint32_t record = (uint32_t)id;
+
+		out.append((const char*)&record, sizeof(record));
+		return;
+	}
+
+	appendNumber(out, id);
+	out.push_back('\n');
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <deque>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// the binary input the solver reads without parsing text (--binary):
+// header (magic, version, byte order, start, end, distance, 0) as uint32, then one record of three uint32 per edge
+// (start, end, distance), a record of three EDGES_END, then one uint32 per savehouse until the end of the file
+#define EDGES_MAGIC "DSEDGES"		// first 8 bytes of a binary input (with the 0 byte)
+#define EDGES_VERSION 1				// has to be the same in the solver
+#define EDGES_BYTE_ORDER 0x01020304	// reads differently on a machine with another byte order
+#define EDGES_END UINT32_MAX		// no id can be this big, so it ends the edges
+
+#define WRITE_BLOCK_SIZE (1 << 22)	// the block that is filled is handed to the thread at this size (4 MiB)
+#define WRITE_QUEUE_SIZE (1 << 26)	// the caller waits while this much is not written yet (64 MiB)
+
+class writer
+{
+private:
+	std::ofstream _file;
+	bool _binary;
+
+	std::string _current;				// the block that is filled while the thread writes the others
+	std::deque<std::string> _full;		// blocks for the thread, the front one is being written
+	std::vector<std::string> _spare;	// written blocks, kept for their memory
+	size_t _queued;						// bytes in _full
+
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::thread _thread;
+	bool _threaded;
+	bool _closing;
+	bool _failed;
+
+	void run();
+	void submit(std::string &block);
+
+public:
+	writer(const char *path, bool binary);
+	~writer();
+
+	bool isBinary() const;
+	bool hasFailed();
+
+	void writeHeader(uint64_t start, uint64_t end, uint64_t distance);
+	void writeEdge(uint64_t from, uint64_t to, uint64_t distance);
+	void endEdges();
+	void writeSaveHouse(uint64_t id);
+
+	void write(const std::string &data);
+	void writeBlock(std::string &block);
+
+	bool close();
+
+	static void appendNumber(std::string &out, uint64_t value);
+	static void appendEdge(std::string &out, uint64_t from, uint64_t to, uint64_t distance, bool binary);
+	static void appendSaveHouse(std::string &out, uint64_t id, bool binary);
+};
@@ -1,4 +1,5 @@
 /* Matrikelnummer: 581323 ; Levin Palm <palmlevi@informatik.hu-berlin.de> */
+#define _POSIX_C_SOURCE 200809L /* fileno, mmap etc. even with -std=c11 */
 #include <stdio.h> /* fprintf etc. */
 #include <stdlib.h> /* malloc/calloc etc. */
 #include <stdint.h> /* uint32_t etc. */
@@ -7,10 +8,78 @@
 #include <stdbool.h> /* bool type */
 #include <inttypes.h> /* PRIu32 etc. */
 #include <errno.h>  /* error handling */
+#include <time.h> /* timespec_get for the query latency */
+
+#if defined(__unix__) || defined(__APPLE__)
+#define POSIX_AVAILABLE 1
+#include <sys/mman.h> /* mmap */
+#include <sys/stat.h> /* fstat */
+#include <unistd.h> /* lseek, sysconf */
+#include <pthread.h> /* threads for the sorts */
+#include <signal.h> /* ignore SIGPIPE in server mode */
+#include <sys/socket.h> /* unix domain socket for the server mode */
+#include <sys/un.h>
+#include <sys/resource.h> /* getrusage for --stats */
+#else
+#define POSIX_AVAILABLE 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_AVAILABLE 1
+#include <emmintrin.h> /* SSE2 intrinsics for the number scanner */
+#else
+#define SIMD_AVAILABLE 0
+#endif
+
+#if SIMD_AVAILABLE && (defined(__SSSE3__) || defined(__AVX__))
+#define SSSE3_AVAILABLE 1
+#include <tmmintrin.h> /* SSSE3 byte shuffle for the gaps of packed neighbours */
+#else
+#define SSSE3_AVAILABLE 0
+#endif
+
+#if SIMD_AVAILABLE && defined(__AVX2__)
+#define AVX2_AVAILABLE 1
+#include <immintrin.h> /* AVX2 for the distance lanes of a batch (all of them in one register) */
+#else
+#define AVX2_AVAILABLE 0
+#endif
+
+#if defined(_MSC_VER)
+#define ALWAYS_INLINE static __forceinline /* for the kernels that only exist to be copied with constant arguments */
+#else
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline uint32_t countTrailingZeros(uint32_t value) { unsigned long index; _BitScanForward(&index, value); return (uint32_t)index; }
+#else
+#define countTrailingZeros(VALUE) ((uint32_t)__builtin_ctz(VALUE))
+#endif
+
+#if defined(_MSC_VER)
+static inline uint32_t bitLength(uint32_t value) { unsigned long index; return _BitScanReverse(&index, value) ? (uint32_t)index + 1 : 0; }
+#else
+#define bitLength(VALUE) ((0 == (VALUE)) ? 0 : 32 - (uint32_t)__builtin_clz(VALUE)) /* how many bits are needed for VALUE */
+#endif
+
+#if defined(_MSC_VER) /* (the 64 bit intrinsics are not there on 32 bit and __popcnt64 needs a cpu with popcnt) */
+static inline uint32_t countTrailingZeros64(uint64_t value) { return (0 != (uint32_t)value) ? countTrailingZeros((uint32_t)value) : 32 + countTrailingZeros((uint32_t)(value >> 32)); }
+static inline uint32_t popCount64(uint64_t value)
+{
+	value -= (value >> 1) & 0x5555555555555555ULL;
+	value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (uint32_t)((value * 0x0101010101010101ULL) >> 56);
+}
+#else
+#define countTrailingZeros64(VALUE) ((uint32_t)__builtin_ctzll(VALUE))
+#define popCount64(VALUE) ((uint32_t)__builtin_popcountll(VALUE)) /* how many bits are set */
+#endif
 
 /* How much memory should be allocated in the beginning */
 #define MEMORY_START_SIZE 32 /* for data */
-#define SUB_NODE_START_SIZE 2 /* for neighbours in a node */
 #define INFINITY32 UINT32_MAX /* infinity for dijkstra, because all numbers are smaller */
 #define INFINITY64 UINT64_MAX /* than 4*10^9 we can use the values above that for whatever */
 
@@ -19,12 +88,147 @@
 #define RESULT_INPUT_ERR 0x2
 #define RESULT_OUT_OF_RANGE 0x4
 #define RESULT_INPUT_EMPTY 0x8
+#define RESULT_FILE_ERR 0x10
+#define RESULT_SNAPSHOT_ERR 0x20
+#define RESULT_HIERARCHY_ERR 0x40
+#define RESULT_EXTERNAL_ERR 0x80
+#define RESULT_SINGLE_NUMBER 0x100 /* only from parseTriple: the line is a single number (the savehouses start there) */
+
+#define INPUT_BLOCK_SIZE (1 << 22) /* how many bytes are read at once if the input can not be mapped (4 MiB) */
+#define MAX_ID 4000000000ULL /* every number in the input has to be smaller than this */
+#define NODE_MAP_START_BITS 10 /* the node dictionary starts with 2^10 slots (if the input size is not known) */
+#define NODE_MAP_EMPTY UINT32_MAX /* id of a free slot, no id can be this big */
+#define NODE_HASH 0x9E3779B97F4A7C15ULL /* fibonacci hashing: the upper bits of id * this pick the slot */
+#define NODE_GROUP_BITS 3 /* 8 neighbouring ids share one cache line of slots (ids in the input are often close to each other) */
+#define BYTES_PER_NODE 16 /* a mapped input with n bytes has at most about n / this different ids (sizes the dictionary) */
+#define NODE_MAP_RESERVE_LIMIT (1 << 18) /* but it reserves no more than this many, beyond that it grows with the ids it really gets */
+
+#define MAX_THREADS 64 /* upper limit for --threads */
+#define RADIX_BITS 11 /* the sorts look at 11 bits per pass, ids are < 2^32 so 3 passes are enough */
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES 3
+#define PARALLEL_SORT_MIN (1 << 16) /* below this many elements starting threads costs more than it saves */
+#define PARALLEL_PARSE_MIN (1 << 20) /* a mapped text input gets split up for the threads from this many bytes on */
+#define BYTES_PER_EDGE 16 /* a part with n bytes has about n / this edges (first size of its buffer) */
+
+#define QUEUE_AUTO 0 /* priority queues for dijkstra (--queue=) */
+#define QUEUE_BINARY 1
+#define QUEUE_RADIX 2
+#define QUEUE_BUCKET 3
+#define STORAGE_BLOCKS 0 /* where dijkstraKernel finds the neighbours: one block per node in neighbours */
+#define STORAGE_PACKED 1 /* --compress: they have to be unpacked first */
+#define STORAGE_PAGED 2 /* --external: a block comes page by page out of the file */
+#define BUCKET_QUEUE_LIMIT (1 << 22) /* the bucket queue needs one list head per possible distance */
+#define RADIX_HEAP_BUCKETS 33 /* keys are <= globalDistance < 2^32, bucket i holds keys that differ from last in bit i-1 */
+
+#define SEARCH_DIJKSTRA 0 /* how the distances are calculated (--search=) */
+#define SEARCH_DELTA 1
+#define SEARCH_HIERARCHY 2
+#define DELTA_BUCKETS_MAX (1 << 16) /* delta gets raised until limit / delta fits, so the buckets never wrap around */
+#define DELTA_SAMPLE 4096 /* without --delta it is the mean weight of this many edges */
+#define DELTA_FAILED UINT32_MAX /* vote of a thread that could not allocate */
+#define DELTA_GATE_CLOSED 0 /* the threads of a delta-stepping search wait until they are all there */
+#define DELTA_GATE_OPEN 1
+#define DELTA_GATE_ABORT 2
+#define WEIGHTS_MIXED 0 /* edges_t weight / graph_t hopWeight: the edges do not all have the same weight (or it is 0, then hops say nothing) */
+#define BFS_ALPHA 14 /* breadthFirst goes bottom-up once the frontier has more than 1 / 14 of the unexplored edges */
+#define BFS_BETA 24 /* and top-down again once the frontier has less than 1 / 24 of the nodes */
+#define BATCH_LANES 8 /* a batch search runs this many queries in one pass (one AVX2 register of distances, two SSE2 ones) */
+#define BATCH_QUERIES_MAX 4096 /* "batch n" takes at most this many query lines */
+
+#define HIERARCHY_WITNESS_SETTLED 64 /* a witness search gives up after this many nodes (then the shortcut is added, which is never wrong) */
+#define HIERARCHY_SHORTCUT_FACTOR 4 /* the preprocessing gives up if there are more shortcuts than this times edges + nodes */
+#define HIERARCHY_WORK_FACTOR 25 /* or if it looked at more edges than this times edges + nodes (the core that is left is too dense) */
+#define HIERARCHY_PRIORITY_BIAS ((uint64_t)1 << 31) /* priorities can be negative, the keys of the heap can not (they are distances) */
+#define HIERARCHY_HUB_DEGREE 64 /* nodes with more edges than this are contracted last (one at the bottom makes every search from it huge) */
+
+#define PACKED_PADDING 16 /* zero bytes after the packed neighbours, the weights are read 8 bytes at a time and the gaps 16 */
+#define PACKED_BLOCK_BITS 6 /* every 64 nodes have one 64 bit start in packed, the position of each node is 32 bits relative to it */
+
+#define EXTERNAL_MEMORY_DEFAULT 256 /* --external: MiB for the edges in memory if there is no --memory= */
+#define EXTERNAL_MEMORY_MAX 65536 /* (the edge buffer has to stay below 2^32 edges) */
+#define EXTERNAL_PAGE_NEIGHBOURS 512 /* the neighbours files are read in pages of 4 KiB (a search jumps around, bigger ones read mostly what it does not need) */
+#define EXTERNAL_RUN_BUFFER_MIN 512 /* every sorted run gets at least this many edges of the merge buffer, so the reads stay long */
+
+#define STATS_READ 0 /* the phases --stats reports the wall time of */
+#define STATS_SORT 1
+#define STATS_BUILD 2 /* (numbering the nodes and the blocks) */
+#define STATS_HIERARCHY 3
+#define STATS_COMPRESS 4
+#define STATS_SEARCH 5
+#define STATS_OUTPUT 6
+#define STATS_PHASES 7
+#if defined(__APPLE__)
+#define STATS_RSS_UNIT 1 /* ru_maxrss is in bytes there */
+#else
+#define STATS_RSS_UNIT 1024 /* and in KiB everywhere else */
+#endif
+
+#define QUERY_LINE_SIZE 128 /* a query is three numbers, so this is plenty */
+
+#define EDGE_REMOVED INFINITY32 /* weight of a removed edge (server mode), longer than any limit so every search skips it */
+#define UPDATE_ADD_EDGE 0 /* what an update does to the edges from one node to another */
+#define UPDATE_REMOVE_EDGE 1
+#define UPDATE_SET_WEIGHT 2
+#define REPAIR_UNSEEN 0 /* marks of the nodes while a longer (or removed) edge is repaired */
+#define REPAIR_SEEN 1 /* waits to be checked or has another shortest way, so its distance stays */
+#define REPAIR_AFFECTED 2 /* every shortest way went through the edge, it gets searched again */
+
+#define SNAPSHOT_MAGIC "DSGRAPH" /* first 8 bytes of a snapshot file (with the 0 byte) */
+#define SNAPSHOT_VERSION 3 /* increase whenever the layout of the file changes */
+#define SNAPSHOT_BYTE_ORDER 0x01020304 /* reads differently on a machine with another byte order */
+#define SNAPSHOT_ALIGNMENT 64 /* every section starts at a multiple of this (one cache line) */
+#define SNAPSHOT_IDS 0 /* the sections of a snapshot, in the order they are in the file */
+#define SNAPSHOT_SAVEHOUSE_BITS 1
+#define SNAPSHOT_OUT_OFFSETS 2
+#define SNAPSHOT_OUT_NEIGHBOURS 3
+#define SNAPSHOT_IN_OFFSETS 4
+#define SNAPSHOT_IN_NEIGHBOURS 5
+#define SNAPSHOT_SAVEHOUSES 6
+#define SNAPSHOT_ORDER 7 /* the hierarchy sections are empty if the snapshot has none */
+#define SNAPSHOT_UP_OFFSETS 8
+#define SNAPSHOT_UP_NEIGHBOURS 9
+#define SNAPSHOT_DOWN_OFFSETS 10
+#define SNAPSHOT_DOWN_NEIGHBOURS 11
+#define SNAPSHOT_SECTIONS 12
+
+#define EDGES_MAGIC "DSEDGES" /* first 8 bytes of a binary input (the generator writes it with --binary) */
+#define EDGES_VERSION 1 /* has to be the same in the generator */
+#define EDGES_BYTE_ORDER 0x01020304 /* reads differently on a machine with another byte order */
+#define EDGES_END UINT32_MAX /* a record of three of these ends the edges, every uint32_t after it is a savehouse */
+#define EDGES_RECORD_SIZE (3 * sizeof(uint32_t)) /* start, end and distance of one edge */
+
+#define TEST_BIT(BITS, INDEX) (((BITS)[(INDEX) >> 6] >> ((INDEX) & 63)) & 1) /* bitmaps are arrays of uint64_t */
+#define SET_BIT(BITS, INDEX) ((BITS)[(INDEX) >> 6] |= (uint64_t)1 << ((INDEX) & 63))
+#define CLEAR_BIT(BITS, INDEX) ((BITS)[(INDEX) >> 6] &= ~((uint64_t)1 << ((INDEX) & 63)))
+#define BITMAP_WORDS(COUNT) (((size_t)(COUNT) + 63) >> 6) /* how many uint64_t a bitmap of COUNT bits needs */
+
+typedef struct nodeSlot_t /* one place in the node dictionary */
+{
+	uint32_t id; /* NODE_MAP_EMPTY if the place is free */
+	uint32_t index; /* the dense index of the id */
+} nodeSlot_t;
+
+typedef struct nodeMap_t /* gives every id a dense index (in the order they are seen), all zero is an empty map */
+{
+	nodeSlot_t *slots; /* open addressing with linear probing, at most half of them are used */
+	size_t capacity; /* how many slots (a power of 2) */
+	uint32_t shift; /* 64 - log2(capacity) */
+	uint32_t count; /* how many ids have an index */
+	uint32_t *ids; /* the id of every index (space for capacity / 2) */
+} nodeMap_t;
+
+bool reserveNodes(nodeMap_t*, const size_t); /* makes room for that many ids, so the map does not have to grow */
+static inline size_t hashNode(const uint32_t, const uint32_t); /* first slot to look at for the id (shift of the map) */
+static inline uint32_t mapNode(nodeMap_t*, const uint32_t); /* index of the id, a new one if it was not seen before (INFINITY32 if out of memory) */
+uint32_t lookupNode(const nodeMap_t*, const uint32_t); /* index of the id or INFINITY32 */
+void freeNodeMap(nodeMap_t*);
 
 /* RAW data out of the file */
 typedef struct edge_t
 {
-	uint32_t startID; /* edge from */
-	uint32_t endID; /* to */
+	uint32_t start; /* edge from (the dense index of the node, see nodeMap_t) */
+	uint32_t end; /* to */
 	uint64_t distance; /* with this weight/distance */
 } edge_t;
 
@@ -33,11 +237,15 @@ typedef struct edges_t
 	uint32_t count; /* size of actually used memory */
 	uint32_t limit; /* size of allocated memory */
 	edge_t *data; /* pointer to data itself */
+	nodeMap_t nodes; /* the ids behind the indices in data */
+	FILE *spill; /* --external: a full buffer gets appended to this file instead of growing (NULL otherwise) */
+	uint64_t spilled; /* how many edges are in there */
+	uint32_t weight; /* the weight all edges so far have (INFINITY32 before the first one), WEIGHTS_MIXED if they differ */
 } edges_t;
 
-bool insertEdge(edges_t*__restrict, edge_t*__restrict); /* tries to insert an edge */
-
-uint32_t findFirstEdge(edges_t*, uint32_t); /* finds the first index of the nodes with the given id */
+bool insertEdge(edges_t*__restrict, const uint32_t, const uint32_t, const uint64_t); /* tries to insert an edge (start and end id, distance) */
+static inline uint32_t mergeWeight(const uint32_t, const uint32_t); /* the weight of edges_t after one more edge */
+bool spillEdges(edges_t*); /* --external: appends the buffer to the spill file and empties it */
 
 typedef struct savehouses_t
 {
@@ -46,40 +254,282 @@ typedef struct savehouses_t
 	uint32_t *data; /* the savehouses */
 } savehouses_t;
 
-bool insertSaveHouse(savehouses_t*__restrict, const uint32_t); /* tries to insert a savehouse id */
-bool checkSaveHouse(savehouses_t*__restrict, const uint32_t); /* checks if the given id is a savehouse */
+bool insertSaveHouse(savehouses_t*__restrict, const uint32_t); /* tries to insert a savehouse id (duplicates are dropped after sorting) */
+void dropDuplicateSaveHouses(savehouses_t*); /* the savehouses have to be sorted */
+bool checkSaveHouse(savehouses_t*__restrict, const uint32_t); /* checks if the given id is a savehouse (sorted, for ids without a node) */
+uint64_t andBitmaps(uint64_t*__restrict, const uint64_t*__restrict, const uint64_t*__restrict, const size_t); /* target &= a & b, gives how many bits are left */
 
 typedef struct neighbour_t /* represents one neighbour of a node */
 {
 	uint32_t index;    /* the index in the node list of the neighbour node */
-	uint64_t distance; /* the distance between the two nodes */
+	uint32_t distance; /* the distance between the two nodes (always < 4*10^9, EDGE_REMOVED if it is gone) */
 } neighbour_t;
 
-typedef struct node_t /* structured data to work with */
+typedef struct addedEdge_t /* an edge that was added in server mode, the block of its node has no room for it */
+{
+	neighbour_t edge;
+	uint32_t next; /* the next added edge of the same node (INFINITY32 at the end) */
+} addedEdge_t;
+
+typedef struct vertices_t /* what one dijkstra run needs to know about the nodes, one array each (the inner loop only loads what it looks at) */
+{
+	uint32_t *distances; /* distance from the start node, INFINITY32 if not reached (every limit is < MAX_ID, so 32 bits are enough) */
+	uint64_t *visited; /* bitmap: is the distance of the node final? */
+} vertices_t;
+
+static inline uint32_t addDistance(const uint32_t, const uint32_t); /* distance + weight, INFINITY32 if that does not fit */
+
+typedef struct pager_t /* --external: the neighbours of one direction stay in a file, some pages of it are kept in frames (CLOCK) */
+{
+	FILE *file; /* the neighbours exactly as they would be in the block */
+	uint32_t count; /* how many neighbours are in there */
+	uint32_t frameCount; /* as many as fit into the memory budget (at least one) */
+	uint32_t hand; /* the clock hand, the next frame that may get another page */
+	uint32_t *frameOf; /* the frame of every page (INFINITY32 if it is not in memory) */
+	uint32_t *pageOf; /* the page in every frame (INFINITY32 if the frame is free) */
+	uint64_t *referenced; /* bitmap: was the frame used since the hand came by */
+	neighbour_t *frames; /* EXTERNAL_PAGE_NEIGHBOURS per frame */
+	uint64_t requests; /* pages the search asked for */
+	uint64_t reads; /* and how many of them had to be read */
+} pager_t;
+
+typedef struct mergeRun_t /* --external: how far the merge is in one sorted run of the edges */
+{
+	uint64_t offset; /* next edge of the run in the file that is not in the buffer yet */
+	uint64_t end; /* where the run ends */
+	edge_t *buffer; /* its part of the merge buffer */
+	uint32_t position; /* next edge in there */
+	uint32_t count; /* how many are in there */
+} mergeRun_t;
+
+typedef struct adjacency_t /* the edges of a graph in one direction in compressed sparse row form */
+{
+	uint32_t *offsets; /* the neighbours of node i are neighbours[offsets[i]] to neighbours[offsets[i + 1] - 1] */
+	uint32_t count; /* how many neighbours there are in total */
+	neighbour_t *neighbours; /* the neighbours of all nodes in one block */
+	uint32_t *addedHeads; /* first added edge of every node (INFINITY32 if none), NULL as long as nothing was added */
+	addedEdge_t *added; /* they go into the blocks before the next full search (mergeAddedEdges) */
+	uint32_t addedCount;
+	uint32_t addedLimit;
+	uint64_t *bases; /* --compress: where the neighbours of node i start in packed is bases[i >> PACKED_BLOCK_BITS] + positions[i] */
+	uint32_t *positions; /* (NULL if they are in the blocks) */
+	uint8_t *packed; /* per node: the count, the first index (zigzag, relative to the node) and the gaps to the next ones as
+						varints, then the weights with weightBits bits each (offsets and neighbours are gone then) */
+	size_t packedSize; /* bytes in packed (without the padding) */
+	uint32_t weightBits; /* enough for the longest weight */
+	uint32_t maxDegree; /* the most neighbours one node has, a search unpacks one node at a time */
+	pager_t *pager; /* --external: the neighbours are in a file (neighbours is NULL), NULL otherwise */
+} adjacency_t;
+
+typedef struct edgeCursor_t /* goes through the edges of one node, first its block then the added ones */
+{
+	adjacency_t *adjacency;
+	uint32_t position; /* next edge in the block */
+	uint32_t last; /* end of the block */
+	uint32_t added; /* next added edge (INFINITY32 if there are no more) */
+} edgeCursor_t;
+
+static inline neighbour_t *firstEdge(edgeCursor_t*, adjacency_t*, const uint32_t); /* first edge of the node or NULL, removed ones are skipped */
+static inline neighbour_t *nextEdge(edgeCursor_t*); /* the one after that or NULL */
+
+typedef struct hierarchy_t /* contraction hierarchy for --search=hierarchy, position 0 is the node that was contracted last (the top) */
 {
-	uint32_t id;				/* id of the node */
-	uint64_t distance;			/* distance from the headNode (algorithm) */
-	bool isSaveHouse;			/* is this node a savehouse? */
-	bool visited;				/* was this node seen before? */
-	neighbour_t *neighbours;	/* list of node's neighbours */
-	uint32_t neighboursCount;   /* how many neighbours there are */
-	uint32_t neighboursLimit;   /* how much memory we have */
-} node_t;
+	uint32_t *order; /* the node index at every position, NULL if there is no hierarchy */
+	adjacency_t up; /* per position the edges and shortcuts to positions higher up (the neighbours are positions too) */
+	adjacency_t down; /* per position the ones that come down to it from higher up (the neighbour is where they start) */
+	bool mapped; /* the arrays are part of the snapshot */
+} hierarchy_t;
 
-typedef struct graph_t /* this represents the graph in a graph-like structure */
+typedef struct graph_t /* the graph, with the edges stored in both directions */
 {
 	uint32_t count; /* how many nodes there are */
-	uint32_t limit; /* for how much nodes we have space */
-	node_t *vertices; /* the nodes itself */
+	uint32_t *ids; /* id of every node, sorted (so the index of an id can be found by binsearch) */
+	uint64_t *saveHouseBits; /* bit i is set if node i is a savehouse */
+	savehouses_t saveHouses; /* every savehouse id, sorted (also the ones that are not a node, for a node its bit counts) */
+	adjacency_t out; /* edges start -> end, for the search from the start node */
+	adjacency_t in; /* the same edges end -> start, for the search towards the end node */
+	hierarchy_t hierarchy; /* empty unless --search=hierarchy, edge updates drop it */
+	uint32_t hopWeight; /* the weight of every edge if they all have the same one (WEIGHTS_MIXED otherwise), then a search counts hops */
+	void *snapshot; /* the snapshot file all arrays above point into (NULL if they are allocated) */
+	size_t snapshotSize; /* length of the mapping */
 } graph_t;
 
-bool buildGraph(savehouses_t*__restrict, edges_t*__restrict, graph_t*__restrict);
+int loadGraph(graph_t*); /* reads the input and builds the graph from it */
+bool buildGraph(savehouses_t*__restrict, edges_t*__restrict, graph_t*__restrict); /* takes over the savehouses, the edges stay as they are */
+bool hasEdgeWithin(adjacency_t*__restrict, const uint32_t, const uint32_t, const uint64_t); /* is one of these neighbours close enough? */
+
+bool compressGraph(graph_t*); /* packs both directions and drops the blocks, only dijkstra can search them then (--compress) */
+bool compressAdjacency(adjacency_t*, const uint32_t); /* the packed form next to the blocks (node count) */
+void freePacked(adjacency_t*);
+bool appendPacked(adjacency_t*__restrict, size_t*__restrict, const size_t); /* makes room for that many more bytes */
+static inline uint32_t unpackNeighbours(const adjacency_t*__restrict, const uint32_t, neighbour_t*__restrict); /* the neighbours of the node (how many) */
+static inline uint8_t *writeGaps(uint8_t*__restrict, const neighbour_t*__restrict, const uint32_t); /* the index gaps of sorted neighbours (count) */
+static inline const uint8_t *readGaps(const uint8_t*__restrict, const uint32_t, uint32_t, neighbour_t*__restrict); /* the indices back from the gaps (count, index before) */
+void createGapShuffles(void); /* the tables readGaps decodes 4 gaps at a time with (SSSE3) */
+static inline uint8_t *writeVarint(uint8_t*, uint64_t); /* 7 bits per byte, the high bit says that more follow */
+static inline uint64_t readVarint(const uint8_t**);
+static inline uint64_t loadLittle64(const uint8_t*); /* 8 bytes as little endian on every machine */
+
+FILE *openScratch(void); /* --external: a new file in that directory, it is gone once it gets closed */
+bool readScratch(FILE*, void*, const size_t, const uint64_t); /* size bytes from an offset on (pread where there is one) */
+bool buildExternalAdjacency(edges_t*__restrict, graph_t*__restrict, const uint32_t*__restrict); /* sorts the spilled edges on disk (order of buildGraph) */
+bool mergeRuns(FILE*__restrict, FILE*__restrict, edge_t*__restrict, const uint64_t, const uint64_t, const uint64_t); /* the sorted runs as one neighbours file */
+bool refillRun(FILE*__restrict, mergeRun_t*__restrict, const uint64_t); /* the next part of one run */
+bool createPager(adjacency_t*__restrict, FILE*__restrict, const uint64_t); /* takes over the file, bytes for the frames */
+static inline const neighbour_t *pageNeighbours(pager_t*__restrict, const uint32_t, uint32_t*__restrict); /* neighbours from a position on in one page */
+uint32_t loadPage(pager_t*, const uint32_t); /* reads the page into a frame (which one, INFINITY32 if it could not be read) */
+void freePager(adjacency_t*);
+
+uint32_t shortestEdge(adjacency_t*, const uint32_t, const uint32_t); /* weight of the shortest edge from -> to (EDGE_REMOVED if none) */
+uint32_t changeEdges(adjacency_t*, const uint32_t, const uint32_t, const uint32_t); /* gives every edge from -> to the weight, returns the shortest before */
+bool insertAddedEdge(graph_t*, const uint32_t, const uint32_t, const uint32_t); /* adds an edge in both directions (from, to, weight) */
+bool reserveAddedEdge(adjacency_t*, const uint32_t); /* makes room for one more added edge (node count) */
+bool mergeAddedEdges(graph_t*); /* moves the added edges into the blocks and drops the removed ones */
+bool mergeAdjacency(adjacency_t*, const uint32_t); /* the same for one direction (node count) */
+bool updateSaveHouse(graph_t*, const uint32_t, const bool); /* adds or removes a savehouse id */
+
+typedef struct snapshotHeader_t /* the start of a snapshot file, the arrays of the graph follow exactly as they are in memory */
+{
+	char magic[8]; /* SNAPSHOT_MAGIC */
+	uint32_t version; /* SNAPSHOT_VERSION */
+	uint32_t byteOrder; /* SNAPSHOT_BYTE_ORDER of the machine that wrote it */
+	uint32_t nodeCount;
+	uint32_t edgeCount;
+	uint32_t saveHouseCount;
+	uint32_t startID; /* the first line of the input the graph was built from */
+	uint32_t endID;
+	uint32_t hierarchy; /* 1 if the hierarchy sections are filled */
+	uint32_t upCount; /* edges in the hierarchy */
+	uint32_t downCount;
+	uint32_t reserved; /* always 0 */
+	uint64_t distance;
+	uint64_t fileSize; /* to notice truncated files */
+	uint64_t offsets[SNAPSHOT_SECTIONS]; /* where each section starts, counted from the start of the file */
+} snapshotHeader_t;
+
+void fillSnapshotHeader(graph_t*__restrict, snapshotHeader_t*__restrict); /* everything but the offsets and the size */
+void snapshotSectionSizes(const snapshotHeader_t*__restrict, uint64_t*__restrict); /* how many bytes every section has */
+void snapshotArrays(graph_t*__restrict, void***__restrict); /* where the graph keeps the array of every section */
+bool writeSnapshot(const char*__restrict, graph_t*__restrict); /* exports the graph */
+int loadSnapshot(const char*__restrict, graph_t*__restrict); /* maps an exported graph, nothing gets copied */
+bool detachSnapshot(graph_t*); /* copies the arrays out of the snapshot, so they can grow */
+
+typedef struct search_t /* one run of dijkstra, any number of them can work on the same graph at once */
+{
+	graph_t *graph;
+	adjacency_t *adjacency; /* which direction to go (&graph->out or &graph->in) */
+	uint32_t startIndex; /* where to start */
+	uint64_t limit; /* nodes further away are not of interest */
+	vertices_t vertices; /* distance and visited bit of every node (graph->count) */
+	uint64_t *reached; /* bitmap of the nodes within limit */
+	const uint64_t *targets; /* bitmap of the only nodes that matter (NULL if all do), the search stops once they are all reached */
+	uint64_t targetCount; /* how many bits are set in there */
+	bool success; /* false if an allocation failed */
+	uint64_t pops; /* counted by dijkstra for --stats (in registers, they are only stored at the end): nodes that were visited */
+	uint64_t relaxed; /* edges that were looked at */
+	uint64_t pushes; /* nodes that got into the queue */
+	uint64_t decreaseKeys; /* nodes in the queue that got a shorter distance */
+} search_t;
+
+bool createSearch(search_t*__restrict, graph_t*__restrict, adjacency_t*__restrict, const uint32_t, const uint64_t); /* prepares a search */
+bool dijkstra(search_t*); /* perform dijkstra on the graph starting with startIndex, up to limit */
+bool breadthFirst(search_t*); /* the same result as dijkstra if the graph has a hopWeight, level by level instead of a queue */
+
+typedef struct batch_t /* up to BATCH_LANES searches in the same direction that share one pass over the edges */
+{
+	graph_t *graph;
+	adjacency_t *adjacency; /* which direction to go (&graph->out or &graph->in) */
+	uint32_t starts[BATCH_LANES]; /* the start of every lane (INFINITY32 if the lane is not used) */
+	uint32_t limits[BATCH_LANES]; /* nodes further away are INFINITY32 in that lane */
+	uint32_t *lanes; /* BATCH_LANES distances per node, node after node */
+	vertices_t vertices; /* the key of every node for the queue: the shortest of its distances that were not passed on yet */
+	bool success; /* false if an allocation failed */
+	uint64_t pops; /* for --stats, like in search_t */
+	uint64_t relaxed;
+} batch_t;
+
+bool createBatch(batch_t*__restrict, graph_t*__restrict, adjacency_t*__restrict); /* prepares a batch without any lane */
+bool batchSearch(batch_t*); /* dijkstra for all lanes at once, a node goes into the queue again whenever one of its lanes gets shorter */
+void *runBatch(void*); /* batchSearch as thread worker */
+static inline uint32_t relaxLanes(uint32_t*__restrict, const uint32_t*__restrict, const uint32_t, const uint32_t*__restrict); /* one edge for all lanes */
+void freeBatch(batch_t*);
+void *runSearch(void*); /* dijkstra (or breadth first, delta-stepping or phast) as thread worker */
+void freeSearch(search_t*);
+
+typedef struct deltaEntry_t /* a node in a bucket or a request to relax it */
+{
+	uint32_t index;
+	uint32_t distance; /* the tentative distance it has (or would get) */
+} deltaEntry_t;
+
+typedef struct deltaList_t
+{
+	uint32_t count; /* how many entries there are */
+	uint32_t limit; /* how much space there is */
+	deltaEntry_t *data;
+} deltaList_t;
 
-bool dijkstra(graph_t*__restrict, const uint32_t); /* perform dijkstra on graph starting with index */
+typedef struct deltaShared_t /* what all threads of one delta-stepping search work on */
+{
+	adjacency_t *adjacency;
+	uint32_t threads;
+	uint32_t delta; /* edges up to this long are light */
+	uint64_t limit;
+	uint32_t bucketCount; /* bucket i holds distances i * delta to (i + 1) * delta - 1 */
+	uint32_t *distances; /* the distances of the search (tentative until the end), only written by the thread that owns the node */
+	bool *settled; /* is the node in the settled list of its thread (for the heavy edges) */
+	deltaList_t *requests; /* threads * threads buffers, requests[from * threads + to] */
+	uint32_t *votes; /* one per thread, read by all after a barrier */
+#if POSIX_AVAILABLE
+	pthread_mutex_t mutex; /* barrier */
+	pthread_cond_t condition;
+#endif
+	uint32_t waiting; /* how many threads are at the barrier */
+	uint32_t generation; /* how often the barrier was passed */
+	uint32_t gate; /* DELTA_GATE_* */
+} deltaShared_t;
+
+typedef struct deltaWorker_t /* one thread of a delta-stepping search */
+{
+	deltaShared_t *shared;
+	uint32_t id;
+	deltaList_t *buckets; /* the buckets of the nodes this thread owns (bucketCount) */
+	deltaList_t frontier; /* the bucket that is relaxed at the moment */
+	deltaList_t settled; /* nodes of the current bucket, their heavy edges come last */
+	bool failed; /* an allocation failed */
+} deltaWorker_t;
+
+bool deltaStepping(search_t*); /* same result as dijkstra, but on threadCount threads */
+void *deltaWork(void*); /* one of these threads */
+uint32_t chooseDelta(adjacency_t*__restrict, const uint64_t); /* --delta or a guess from the weights */
+bool appendDeltaEntry(deltaList_t*__restrict, const uint32_t, const uint32_t);
+
+int findSaveHouses(graph_t*__restrict, const uint32_t, const uint32_t, const uint64_t, savehouses_t*__restrict); /* both searches + intersection */
+void runSearchPair(search_t*); /* runs the two searches, at the same time if there are threads */
+int findSaveHousesBatch(graph_t*__restrict, const uint64_t (*)[3], const uint32_t, savehouses_t*__restrict); /* findSaveHouses for up to BATCH_LANES queries at once */
+bool answerIsolated(graph_t*__restrict, const uint32_t, const uint32_t, savehouses_t*__restrict); /* a node without edges can be the answer to itself */
+int listSaveHouses(graph_t*__restrict, const uint64_t*__restrict, const uint64_t, savehouses_t*__restrict); /* the ids of the set bits (how many) */
 
 uint32_t findNode(graph_t*__restrict, const uint32_t); /* find node with id in graph and give index */
-bool insertChildNode(node_t*__restrict, const uint32_t, const uint64_t); /* inserts a childnode into the parent node */
-bool insertNode(graph_t*__restrict, node_t); /* inserts a node into the node collection */
+
+typedef struct stats_t /* --stats: what the solver did, written as JSON at the end */
+{
+	double phases[STATS_PHASES]; /* wall time of every phase in ms (summed over the queries in server mode) */
+	double total; /* from the start to the report */
+	uint64_t nodes; /* size of the graph */
+	uint64_t edges;
+	uint64_t searches; /* two per query (only dijkstra fills the counters below, the other searches leave them 0) */
+	uint64_t pops;
+	uint64_t relaxed;
+	uint64_t pushes;
+	uint64_t decreaseKeys;
+	uint64_t findNodeCalls;
+	uint64_t answer; /* savehouses in the answer (of the last query) */
+} stats_t;
+
+static inline void endPhase(const uint32_t, const double); /* adds the time since the start to the phase */
+void countSearch(const search_t*); /* adds the counters of a search to stats */
+bool writeStats(const int); /* the report, with the exit code */
 
 #define LEFT(INDEX) ((INDEX << 1) | 1) /* calculate left child (2n + 1)*/
 #define RIGHT(INDEX) ((INDEX << 1) + 2) /* calculate right child (2n + 2)*/
@@ -93,56 +543,282 @@ typedef struct heap_t /* this represents the heap */
 	uint32_t *positions; /* saves which element is where in the heap (boost) */
 } heap_t;
 
-bool insertNodeToHeap(graph_t*__restrict, heap_t*__restrict, const uint32_t); /* this inserts the given value into the heap */
-uint32_t removeMinNodeFromHeap(graph_t*__restrict, heap_t*__restrict); /* this gets the "first" (the smallest) element from the heap */
-void siftDownHeap(graph_t*__restrict, heap_t*__restrict, uint32_t); /* this is more for internal use, but basically */
-void siftUpHeap(graph_t*__restrict, heap_t*__restrict, uint32_t);  /* makes sure the heap is a heap after changing values */
+bool insertNodeToHeap(vertices_t*__restrict, heap_t*__restrict, const uint32_t); /* this inserts the given value into the heap */
+uint32_t removeMinNodeFromHeap(vertices_t*__restrict, heap_t*__restrict); /* this gets the "first" (the smallest) element from the heap */
+void siftDownHeap(vertices_t*__restrict, heap_t*__restrict, uint32_t); /* this is more for internal use, but basically */
+void siftUpHeap(vertices_t*__restrict, heap_t*__restrict, uint32_t);  /* makes sure the heap is a heap after changing values */
+
+typedef struct radixEntry_t /* one element in the radix heap */
+{
+	uint32_t key; /* the distance it was inserted with */
+	uint32_t index; /* the node */
+} radixEntry_t;
+
+typedef struct radixBucket_t
+{
+	uint32_t count; /* how many entries are in this bucket */
+	uint32_t limit; /* how much space there is */
+	radixEntry_t *data;
+} radixBucket_t;
+
+typedef struct radixHeap_t /* monotone queue for integer keys, nodes are inserted again instead of moved (lazy deletion) */
+{
+	uint32_t last; /* the last key that was removed, every key in here is >= last */
+	uint32_t count; /* how many entries there are (including outdated ones) */
+	bool failed; /* a bucket could not grow while redistributing */
+	radixBucket_t buckets[RADIX_HEAP_BUCKETS]; /* bucket i > 0 holds the keys whose highest bit that differs from last is bit i - 1 */
+} radixHeap_t;
+
+bool insertNodeToRadixHeap(radixHeap_t*__restrict, const uint32_t, const uint32_t); /* inserts node with key */
+uint32_t removeMinNodeFromRadixHeap(vertices_t*__restrict, radixHeap_t*__restrict); /* gets the node with the smallest key */
+
+typedef struct bucketQueue_t /* dial's algorithm: one doubly linked list per distance */
+{
+	uint32_t bucketCount; /* limit + 1, every possible distance */
+	uint32_t current; /* every bucket below this one is empty */
+	uint32_t count; /* how many nodes are in the queue */
+	uint32_t *heads; /* the first node in every bucket */
+	uint32_t *next; /* the lists go through these (one entry per node) */
+	uint32_t *previous;
+} bucketQueue_t;
+
+void insertNodeToBucketQueue(bucketQueue_t*__restrict, const uint32_t, const uint32_t, const uint32_t); /* (re-)inserts node with new and old key */
+uint32_t removeMinNodeFromBucketQueue(bucketQueue_t*); /* gets a node from the smallest non empty bucket */
+
+typedef struct queue_t /* the queue dijkstra works with, one of the three */
+{
+	uint32_t type; /* QUEUE_BINARY, QUEUE_RADIX or QUEUE_BUCKET */
+	heap_t heap;
+	radixHeap_t radix;
+	bucketQueue_t bucket;
+} queue_t;
+
+bool createQueue(queue_t*__restrict, const uint32_t, const uint64_t); /* allocates the queue type selected by --queue */
+bool insertNodeToQueue(vertices_t*__restrict, queue_t*__restrict, const uint32_t, const uint32_t); /* node got a new (smaller) distance, old one given */
+uint32_t removeMinNodeFromQueue(vertices_t*__restrict, queue_t*__restrict); /* gets the next node to visit (INFINITY32 if empty) */
+ALWAYS_INLINE bool pushNode(vertices_t*__restrict, queue_t*__restrict, const uint32_t, const uint32_t, const uint32_t); /* insertNodeToQueue for a known type */
+ALWAYS_INLINE uint32_t popNode(vertices_t*__restrict, queue_t*__restrict, const uint32_t); /* removeMinNodeFromQueue for a known type */
+ALWAYS_INLINE bool dijkstraQueue(search_t*__restrict, queue_t*__restrict, const uint32_t); /* picks the kernel for the queue type (storage given) */
+ALWAYS_INLINE bool dijkstraKernel(search_t*__restrict, queue_t*__restrict, const uint32_t, const uint32_t); /* dijkstra with the queue type and the storage */
+void freeQueue(queue_t*);
+
+typedef struct neighbourList_t /* the edges of one node while the hierarchy is built */
+{
+	uint32_t count;
+	uint32_t limit;
+	neighbour_t *data;
+} neighbourList_t;
 
-int compare_edges(const void*, const void*); /* these three are just wrappers for compare() */
-int compare_saveHouses(const void*, const void*);
-int compare_nodes(const void*, const void*);
+typedef struct contraction_t /* what buildHierarchy works on */
+{
+	neighbourList_t *out; /* the edges of every node (shortcuts included), the ones to contracted nodes are dropped lazily */
+	neighbourList_t *in; /* (a shortened edge is in here twice, the shorter one counts) */
+	uint32_t *positions; /* where every node ends up, INFINITY32 as long as it is not contracted */
+	uint32_t *deleted; /* how many neighbours are contracted allready (part of the priority) */
+	vertices_t witness; /* distances of the last witness search, the visited bits mark its targets */
+	heap_t heap; /* for the witness searches */
+	uint32_t *touched; /* the nodes the last witness search gave a distance */
+	uint32_t touchedCount;
+	uint32_t targets; /* how many nodes with a visited bit the witness search has not settled yet */
+	edge_t *shortcuts; /* the ones findShortcuts found for the node it looked at last */
+	uint32_t shortcutCount;
+	uint32_t shortcutLimit;
+	uint64_t work; /* edges looked at so far (witness searches, shortcut pairs and edge inserts) */
+} contraction_t;
+
+int buildHierarchy(graph_t*); /* contracts every node, RESULT_HIERARCHY_ERR if there would be too many shortcuts (or it takes too long) */
+uint32_t findShortcuts(contraction_t*, const uint32_t); /* the shortcuts the node needs, how many (INFINITY32 if out of memory) */
+uint32_t hierarchyPriority(contraction_t*, const uint32_t, const uint32_t); /* key of the node with that many shortcuts (smaller goes first) */
+bool witnessSearch(contraction_t*, const uint32_t, const uint32_t, const uint64_t); /* from, without, up to */
+bool addHierarchyEdge(contraction_t*, const uint32_t, const uint32_t, const uint32_t); /* from, to, weight (parallel ones keep the shortest) */
+bool appendNeighbour(neighbourList_t*, const uint32_t, const uint32_t);
+void dropContracted(contraction_t*__restrict, neighbourList_t*__restrict); /* removes the edges to contracted nodes from the list */
+bool phast(search_t*); /* upward search in the hierarchy, then one sweep over every position */
+void freeHierarchy(hierarchy_t*);
+
+typedef struct watch_t /* a query the server keeps, its two searches get repaired after every update instead of run again */
+{
+	bool active; /* false until the first watch command */
+	search_t searches[2]; /* from the start on out and from the end on in, the distances stay exact */
+	queue_t queues[2]; /* one for each search, empty between two updates */
+	uint8_t *marks; /* REPAIR_* of every node, all REPAIR_UNSEEN between two updates */
+	uint32_t *seen; /* the nodes that got a mark */
+	uint64_t *answer; /* room for the intersection of the reached bits */
+	uint32_t touched; /* how many nodes the last update looked at */
+} watch_t;
+
+int startWatch(graph_t*__restrict, watch_t*__restrict, const uint32_t, const uint32_t, const uint64_t); /* searches and keeps a query */
+int answerWatch(graph_t*__restrict, watch_t*__restrict, savehouses_t*__restrict); /* the savehouses of the kept query */
+int updateEdges(graph_t*__restrict, watch_t*__restrict, const uint32_t, const uint32_t, const uint32_t, const uint32_t); /* UPDATE_*, from, to, weight */
+bool repairShorter(watch_t*, const uint32_t, const uint32_t, const uint32_t, const uint32_t); /* search, tail, head, new weight */
+bool repairLonger(watch_t*, const uint32_t, const uint32_t, const uint32_t, const uint32_t); /* search, tail, head, old weight */
+bool propagateRepair(search_t*__restrict, queue_t*__restrict, uint32_t*__restrict); /* dijkstra from what is in the queue */
+static inline bool lowerDistance(vertices_t*__restrict, queue_t*__restrict, const uint32_t, const uint32_t); /* gives a node a shorter distance */
+void restartQueue(queue_t*); /* an empty queue can take keys below the last one again */
+void freeWatch(watch_t*);
+
+typedef void *(*worker_t)(void*); /* what runs on a thread */
+
+void runParallel(worker_t, void*__restrict, const size_t, const uint32_t); /* runs the worker once per job, each on its own thread */
+
+typedef struct radixJob_t /* the part of one pass of a radix sort that one thread does */
+{
+	const void *source; /* read from here (edge_t or uint32_t) */
+	void *target; /* and scatter to there */
+	bool isEdges; /* the element type */
+	size_t first; /* the slice of source this thread is responsible for */
+	size_t last;
+	uint32_t shift; /* which digit */
+	size_t *histogram; /* RADIX_BUCKETS counters, afterwards the positions to write to */
+} radixJob_t;
+
+bool radixSortSaveHouses(savehouses_t*); /* sorts the savehouse ids */
+bool radixSort(void**__restrict, const size_t, const bool); /* the engine behind it, also sorts the ids and the --external runs (edges by start) */
 
 void freeGraph(graph_t*); /* helper methods for freeing complex structures */
 void freeEdges(edges_t*);
 void freeSaveHouses(savehouses_t*);
 
-int readData(savehouses_t*__restrict, edges_t*__restrict); /* reads in the data from stdin */
+typedef struct input_t /* a window onto the raw bytes of the input */
+{
+	const char *data; /* the bytes (either the mapped file or buffer) */
+	size_t size; /* how many bytes in data are valid */
+	size_t position; /* where parsing continues */
+	char *buffer; /* block buffer for inputs that can not be mapped (NULL if mapped) */
+	size_t capacity; /* size of the block buffer */
+	size_t mappedSize; /* length of the mapping (0 if not mapped) */
+	FILE *file; /* where the blocks come from */
+	bool eof; /* true if no more bytes will follow the current window */
+	int error; /* RESULT_OK or why reading stopped early */
+} input_t;
+
+bool openInput(input_t*__restrict, FILE*__restrict); /* maps the file if possible, otherwise prepares block reading */
+bool refillInput(input_t*); /* reads the next block (keeps the unparsed rest) */
+const char *nextLine(input_t*__restrict, const char**__restrict); /* gives the next line (without '\n') or NULL at the end */
+const char *peekInput(input_t*, const size_t); /* the next bytes without consuming them or NULL if there are less */
+void closeInput(input_t*);
+
+typedef struct edgesHeader_t /* the start of a binary input, fixed size records follow (no text to parse) */
+{
+	char magic[8]; /* EDGES_MAGIC */
+	uint32_t version; /* EDGES_VERSION */
+	uint32_t byteOrder; /* EDGES_BYTE_ORDER of the machine that wrote it */
+	uint32_t startID; /* the first line of a text input */
+	uint32_t endID;
+	uint32_t distance;
+	uint32_t reserved; /* always 0 */
+} edgesHeader_t;
+
+int readData(FILE*__restrict, savehouses_t*__restrict, edges_t*__restrict); /* reads in the data from the file (usually stdin) */
+int parseInput(input_t*__restrict, savehouses_t*__restrict, edges_t*__restrict); /* parses edges and savehouses out of the input */
+int parseBinaryInput(input_t*__restrict, savehouses_t*__restrict, edges_t*__restrict); /* the same for the records of a binary input */
+int parseSaveHouses(input_t*__restrict, savehouses_t*__restrict, const char*, const char*); /* the rest of the input starting with the given line */
+static inline int parseTriple(const char*, const char*, const char*, uint64_t*); /* one "start end distance" line */
+
+typedef struct parseJob_t /* one newline aligned part of a mapped text input, parsed by its own thread */
+{
+	const char *first; /* the first line of the part */
+	const char *last; /* right after the last newline of the part (or the end of the input) */
+	const char *limit; /* the end of the input, the number scanner may look that far */
+	edge_t *data; /* the edges of the part, start and end are still the ids (the node dictionary is not thread safe) */
+	uint32_t count;
+	uint32_t capacity;
+	const char *saveHouses; /* the line where the savehouses start if it is in this part (the part ends there), else NULL */
+	uint32_t weight; /* the weight all edges of the part have (like in edges_t) */
+	int result; /* RESULT_OK or the first error in the part */
+} parseJob_t;
+
+int parseParallel(input_t*__restrict, savehouses_t*__restrict, edges_t*__restrict); /* the rest of a mapped text input (after the first line) on threadCount threads */
+void *parsePart(void*); /* worker for parseParallel */
+
+#define IS_DIGIT(CHAR) ((unsigned char)((CHAR) - '0') < 10) /* one compare instead of two */
+static inline const char *parseNumber(const char*, const char*, uint64_t*); /* parses a run of digits */
 
 const char *mallocZeroException = "malloc ran out of memory while allocating!\n"; /* exception message for when malloc fails */
 const char *invalidFormatException = "the given is data is not in a valid format!\n"; /* exception message for when the input format is invalid */
 const char *inputEmptyException = "the input is empty!\n"; /* exception message for when the input is empty */
 const char *numbersOutOfRange = "the numbers in the input are out of range!\n"; /* for negative numbers or ints bigger 4000000000 */
+const char *fileOpenException = "the input file could not be opened!\n"; /* for --input */
+const char *socketException = "the socket could not be set up!\n"; /* for --socket */
+const char *snapshotException = "the snapshot file is not valid!\n"; /* for --snapshot */
+const char *exportException = "the snapshot could not be written!\n"; /* for --export */
+const char *hierarchyException = "the contraction hierarchy would get too big, searching without it!\n"; /* for --search=hierarchy */
+const char *compressException = "the edges could not be compressed, searching them as they are!\n"; /* for --compress */
+const char *externalException = "the edges could not be sorted on disk!\n"; /* for --external */
+const char *statsException = "the statistics could not be written!\n"; /* for --stats */
 
 uint32_t globalStartID; /* this is the first triple in the file */
 uint32_t globalEndID;  /* startID and endID are is the route to find */
 uint64_t globalDistance; /* distance is the maximum distance per day */
 
+uint32_t threadCount = 1; /* how many threads the parallel parts may use */
+uint32_t queueType = QUEUE_AUTO; /* which priority queue dijkstra uses */
+uint32_t searchType = SEARCH_DIJKSTRA; /* dijkstra, delta-stepping or the contraction hierarchy (--search=) */
+uint64_t deltaValue = 0; /* bucket width for delta-stepping, 0 means choose one (--delta=) */
+const char *inputPath = NULL; /* read the graph from this file instead of stdin (--input=) */
+bool serverMode = false; /* keep the graph and answer queries (--serve) */
+const char *socketPath = NULL; /* answer them on this unix domain socket instead of stdin/stdout (--socket=) */
+const char *exportPath = NULL; /* write the graph as snapshot to this file and stop (--export=) */
+const char *snapshotPath = NULL; /* use this snapshot instead of reading the input (--snapshot=) */
+bool compressMode = false; /* pack the edges before the search, for graphs that do not fit otherwise (--compress) */
+const char *externalPath = NULL; /* sort the edges in this directory and search them from there, for inputs bigger than memory (--external=) */
+uint64_t memoryBudget = (uint64_t)EXTERNAL_MEMORY_DEFAULT << 20; /* bytes the edges may take in memory with --external (--memory= in MiB) */
+bool statsMode = false; /* report times and counters as JSON on stderr when done (--stats) */
+const char *statsPath = NULL; /* or in this file (--stats=) */
+stats_t stats; /* (all zero) */
+
+#if SSSE3_AVAILABLE
+uint8_t gapShuffles[256][16]; /* for every control byte of 4 gaps: where the bytes of each gap are (0x80: zero) */
+uint8_t gapBytes[256]; /* and how many bytes they take together */
+#endif
+
+const char *usageMessage = "usage: loesung [--threads=N] [--queue=auto|binary|radix|bucket] [--search=dijkstra|delta|hierarchy]\n"
+						   "               [--delta=N] [--input=FILE] [--compress] [--external=DIR] [--memory=MB]\n"
+						   "               [--serve] [--socket=PATH] [--export=FILE] [--snapshot=FILE] [--stats[=FILE]] < input\n"; /* shown for unknown arguments */
+
+bool parseArguments(int, char**); /* reads the command line options */
+int solve(void); /* everything after the options, gives the exit code */
+double currentMilliseconds(void); /* wall clock time in ms */
+
+bool parseNumbers(const char*, uint64_t*, const uint32_t); /* parses that many numbers like "start end distance" */
+int serveQueries(graph_t*__restrict, watch_t*__restrict, FILE*, FILE*); /* answers queries and updates line by line until EOF */
+int serveCommand(graph_t*__restrict, watch_t*__restrict, const char*, FILE*); /* one line that is not a query */
+int serveBatch(graph_t*__restrict, const char*, FILE*, FILE*); /* "batch n" and the n query lines after it */
+void printAnswer(FILE*, savehouses_t*, const double); /* "count microseconds id id ..." */
+int serveSocket(graph_t*__restrict, watch_t*__restrict, const char*); /* the same for every connection on a socket */
+
 /*====UTIL ROUTINES============================================================*/
-int main(void)
+int main(int argc, char **argv)
 {
-	edges_t edges; /* this will hold the raw edges */
-	savehouses_t saveHouses; /* this will hold all the ids which are savehouses */
+	if (!parseArguments(argc, argv))
+	{
+		fputs(usageMessage, stderr);
 
-	edges.data = (edge_t*)malloc(sizeof(edge_t) * MEMORY_START_SIZE); /* allocate the beginning memory for edges */
-	edges.count = 0;
-	edges.limit = MEMORY_START_SIZE;
+		return 1;
+	}
 
-	saveHouses.data = (uint32_t*)malloc(sizeof(uint32_t) * MEMORY_START_SIZE);
-	saveHouses.count = 0;
-	saveHouses.limit = MEMORY_START_SIZE;
+	double start = currentMilliseconds();
 
-	/* check if any of the allocations failed (usually means that host is out of memory) */
-	if (NULL == edges.data || NULL == saveHouses.data)
-	{
-		fputs(mallocZeroException, stderr);
+	int code = solve();
 
-		freeSaveHouses(&saveHouses);
-		freeEdges(&edges);
+	stats.total = currentMilliseconds() - start;
 
-		return 1;
-	}
+	if (statsMode && !writeStats(code)) fputs(statsException, stderr); /* (the exit code stays the one of the answer) */
+
+	return code;
+}
+
+int solve(void)
+{
+	double loadStart = currentMilliseconds();
+
+	graph_t graph; /* one graph for both directions */
+
+	/* either build the graph from the input or use one that was exported before, if anything is not correct != 0 gets returned */
+	int result = (NULL != snapshotPath) ? loadSnapshot(snapshotPath, &graph) : loadGraph(&graph);
+
+	if (NULL != snapshotPath) endPhase(STATS_READ, loadStart); /* (loadGraph splits its time into the phases itself) */
 
-	int result = readData(&saveHouses, &edges); /* try to read in the data, if anything is not correct != 0 gets returned */
 	if (result != RESULT_OK)
 	{
 		switch (result)
@@ -156,782 +832,5043 @@ int main(void)
 		case RESULT_OUT_OF_RANGE:
 			fputs(numbersOutOfRange, stderr);
 			break;
+		case RESULT_FILE_ERR:
+			fputs(fileOpenException, stderr);
+			break;
+		case RESULT_SNAPSHOT_ERR:
+			fputs(snapshotException, stderr);
+			break;
+		case RESULT_EXTERNAL_ERR:
+			fputs(externalException, stderr);
+			break;
 		case RESULT_INPUT_ERR:
 		default:
 			fputs(invalidFormatException, stderr);
 			break;
 		}
 
-		freeSaveHouses(&saveHouses);
-		freeEdges(&edges);
+		freeGraph(&graph);
 
 		return 1;
 	}
 
-	if (edges.count > 0)
+	stats.nodes = graph.count;
+	stats.edges = graph.out.count;
+
+	if (SEARCH_HIERARCHY == searchType && NULL == graph.hierarchy.order) /* the preprocessing (an exported snapshot can have it allready) */
 	{
-		edge_t *temp = (edge_t*)malloc(sizeof(edge_t) * edges.count); /* adjust the array size to actual size */
+		double start = currentMilliseconds();
 
-		if (NULL == temp)
+		result = buildHierarchy(&graph);
+
+		endPhase(STATS_HIERARCHY, start);
+
+		if (RESULT_HIERARCHY_ERR == result) fputs(hierarchyException, stderr); /* the searches stay dijkstra */
+		else if (RESULT_OK != result)
 		{
 			fputs(mallocZeroException, stderr);
-
-			freeSaveHouses(&saveHouses);
-			freeEdges(&edges);
+			freeGraph(&graph);
 
 			return 1;
 		}
-
-		/* (adjust the space to the size actually used, can free big chunks of unused memory) */
-		memcpy(temp, edges.data, sizeof(edge_t) * edges.count);
-		free(edges.data);
-		edges.data = temp;
-		edges.limit = edges.count;
-
-		/* sort the edges by the startID (quicksort from stdlib.h) this is some investment which will give us binary search */
-		qsort(edges.data, edges.count, sizeof(edge_t), compare_edges);
 	}
-	else
+
+	if (NULL != exportPath) /* only write the graph, the queries come later (--snapshot) */
 	{
-		free(edges.data);
-		edges.data = NULL;
-		edges.limit = 0;
+		bool written = writeSnapshot(exportPath, &graph);
+
+		if (!written) fputs(exportException, stderr);
+
+		freeGraph(&graph);
+
+		return written ? 0 : 1;
 	}
 
-	if (saveHouses.count > 0)
+	if (serverMode) /* answer queries until the input ends */
 	{
-		/* adjust size of savehouses to actual size */
-		uint32_t *temp2 = (uint32_t*)malloc(sizeof(edge_t) * saveHouses.count);
-
-		if (NULL == temp2)
-		{
-			fputs(mallocZeroException, stderr);
+		fprintf(stderr, "ready: %"PRIu32" nodes, %"PRIu32" edges, loaded in %.1f ms\n", graph.count, graph.out.count, currentMilliseconds() - loadStart);
 
-			freeSaveHouses(&saveHouses);
-			freeEdges(&edges);
+		watch_t watch; /* the query that is repaired after updates */
+		memset(&watch, 0, sizeof(watch_t));
 
-			return 1;
-		}
+		result = (NULL != socketPath) ? serveSocket(&graph, &watch, socketPath) : serveQueries(&graph, &watch, stdin, stdout);
 
-		memcpy(temp2, saveHouses.data, sizeof(uint32_t) * saveHouses.count);
-		free(saveHouses.data);
-		saveHouses.data = temp2;
-		saveHouses.limit = saveHouses.count;
+		freeWatch(&watch);
+		freeGraph(&graph);
 
-		qsort(saveHouses.data, saveHouses.count, sizeof(uint32_t), compare_saveHouses);
+		return (RESULT_OK == result) ? 0 : 1;
 	}
-	else
-	{
-		/* if we do not have any save houses the answer is obviously empty */
-		free(saveHouses.data);
-		saveHouses.data = NULL;
-		saveHouses.count = 0;
 
-		freeEdges(&edges);
+	if (0 == graph.saveHouses.count) /* if we do not have any save houses the answer is obviously empty */
+	{
+		freeGraph(&graph);
 
 		return 0;
 	}
 
-
-	if (edges.count == 0) /* if there are no edges we have to check if start==end==savehouse */
+	/* if there are no edges (that are short enough, a snapshot has all of them) we have to check if start==end==savehouse */
+	if (!hasEdgeWithin(&graph.out, 0, graph.out.count, globalDistance))
 	{
-		if (globalStartID == globalEndID && checkSaveHouse(&saveHouses, globalStartID))
+		if (globalStartID == globalEndID && checkSaveHouse(&graph.saveHouses, globalStartID))
 		{
 			fprintf(stdout, "%"PRIu32, globalStartID);
 		}
 
-		freeSaveHouses(&saveHouses);
+		freeGraph(&graph);
 
 		return 0;
 	}
 
-	graph_t graph1; /* create the graph with direction start -> end */
-	graph1.count = 0;
-	graph1.limit = MEMORY_START_SIZE * 2;
-	graph1.vertices = (node_t*)calloc(graph1.limit, sizeof(node_t));
+	uint32_t startIndex = findNode(&graph, globalStartID); /* find the node where it all starts */
 
-	if (NULL == graph1.vertices) /* check if allocation worked */
-	{
-		fputs(mallocZeroException, stderr);
-
-		freeSaveHouses(&saveHouses);
-		freeEdges(&edges);
+	if (globalStartID != globalEndID && !hasEdgeWithin(&graph.out, graph.out.offsets[startIndex], graph.out.offsets[startIndex + 1], globalDistance))
+	{   /* startNode has no neighbours -> nothing can be reached */
+		freeGraph(&graph);
 
 		return 1;
 	}
 
-	if (!buildGraph(&saveHouses, &edges, &graph1)) /* this will build a graph like structure from all the edges we have */
-	{
-		fputs(mallocZeroException, stderr);
-
-		freeSaveHouses(&saveHouses);
-		freeEdges(&edges);
-		freeGraph(&graph1);
-
-		return 1;
-	}
+	double phaseStart = currentMilliseconds();
 
-	uint32_t startIndex = findNode(&graph1, globalStartID); /* find the node from which it all starts */
+	if (compressMode && !compressGraph(&graph)) fputs(compressException, stderr); /* (the checks above still looked at the blocks) */
 
-	if (INFINITY32 == startIndex)
-	{   /* startNode has no neighbours -> nothing can be reached */
-		freeSaveHouses(&saveHouses);
-		freeEdges(&edges);
-		freeGraph(&graph1);
+	if (compressMode) endPhase(STATS_COMPRESS, phaseStart);
 
-		return 1;
-	}
+	savehouses_t saveHouses; /* the answer */
 
-	/* run dijkstra beginning from the start node (calc distance to every other node) */
-	if (!dijkstra(&graph1, startIndex))
+	if (RESULT_OK != findSaveHouses(&graph, globalStartID, globalEndID, globalDistance, &saveHouses))
 	{
 		fputs(mallocZeroException, stderr);
 
 		freeSaveHouses(&saveHouses);
-		freeEdges(&edges);
-		freeGraph(&graph1);
+		freeGraph(&graph);
 
 		return 1;
 	}
 
-	saveHouses.count = 0;
-	
-	for (size_t i = 0; i < graph1.count; i++) 
-	{   /* because on the second run we only have to check the savehouses that could be reached in the first run */
-		if (graph1.vertices[i].isSaveHouse && graph1.vertices[i].distance <= globalDistance)
-		{
-			insertSaveHouse(&saveHouses, graph1.vertices[i].id);
-		}
-	}
+	phaseStart = currentMilliseconds();
 
-	freeGraph(&graph1); /* release the old graph */
+	for (uint32_t i = 0; i < saveHouses.count; i++) fprintf(stdout, "%"PRIu32"\n", saveHouses.data[i]);
 
-	if (0 == saveHouses.count)
-	{
-		freeSaveHouses(&saveHouses);
-		freeEdges(&edges);
+	fflush(stdout);
+	endPhase(STATS_OUTPUT, phaseStart);
 
-		return 0;
-	}
+	freeSaveHouses(&saveHouses);
+	freeGraph(&graph);
+
+	return 0;
+}
 
-	qsort(saveHouses.data, saveHouses.count, sizeof(uint32_t), compare_saveHouses);
+int loadGraph(graph_t *graph)
+{   /* reads the input (stdin or --input), sorts it and builds the graph, which is freeable whatever happens */
+	memset(graph, 0, sizeof(graph_t));
 
-	for (size_t i = 0; i < edges.count; i++) /* reverse all the edges (swap start and end id) */
-	{
-		uint32_t t = edges.data[i].startID;
-		edges.data[i].startID = edges.data[i].endID;
-		edges.data[i].endID = t;
-	}
+	edges_t edges; /* this will hold the raw edges */
+	savehouses_t saveHouses; /* this will hold all the ids which are savehouses */
 
-	qsort(edges.data, edges.count, sizeof(edge_t), compare_edges); /* sort the edges to enable binsearch */
+	memset(&edges.nodes, 0, sizeof(nodeMap_t)); /* the dictionary gets its size from the input (readData) */
+	edges.count = 0;
+	edges.limit = MEMORY_START_SIZE;
+	edges.spill = NULL;
+	edges.spilled = 0;
+	edges.weight = INFINITY32;
 
-	uint32_t t = globalStartID; /* swap start and end */
-	globalStartID = globalEndID;
-	globalEndID = t;
+	/* --external: one buffer that never grows, half of the budget (radixSort needs a second one of the same size) */
+	if (NULL != externalPath) edges.limit = (uint32_t)(memoryBudget / (2 * sizeof(edge_t)));
 
-	graph_t graph2; /* build the reversed graph (end -> start) */
-	graph2.count = 0;
-	graph2.limit = MEMORY_START_SIZE * 2;
-	graph2.vertices = (node_t*)calloc(graph2.limit, sizeof(node_t));
+	edges.data = (edge_t*)malloc(sizeof(edge_t) * edges.limit); /* allocate the beginning memory for edges */
 
-	if (!buildGraph(&saveHouses, &edges, &graph2)) /* and find all savehouses which can be reached from the end */
-	{
-		fputs(mallocZeroException, stderr); /* if this fails we exit */
+	saveHouses.data = (uint32_t*)malloc(sizeof(uint32_t) * MEMORY_START_SIZE);
+	saveHouses.count = 0;
+	saveHouses.limit = MEMORY_START_SIZE;
 
+	/* check if any of the allocations failed (usually means that host is out of memory) */
+	if (NULL == edges.data || NULL == saveHouses.data)
+	{
 		freeSaveHouses(&saveHouses);
 		freeEdges(&edges);
-		freeGraph(&graph2);
 
-		return 1;
+		return RESULT_MALLOC_ERR;
 	}
 
-	startIndex = findNode(&graph2, globalStartID); /* find the node from where to start */
-
-	if (INFINITY32 == startIndex) /* find the node with the start id, if it has no neighbours we exit */
+	if (NULL != externalPath && NULL == (edges.spill = openScratch()))
 	{
 		freeSaveHouses(&saveHouses);
 		freeEdges(&edges);
-		freeGraph(&graph2);
 
-		return 0;
+		return RESULT_EXTERNAL_ERR;
 	}
 
-	/* and then find every savehouse that is in distance from the end node */
-	if (!dijkstra(&graph2, startIndex))
+	double phaseStart = currentMilliseconds();
+	FILE *source = stdin;
+
+	if (NULL != inputPath)
 	{
-		fputs(mallocZeroException, stderr);
+		source = fopen(inputPath, "rb");
+
+		if (NULL == source)
+		{
+			freeSaveHouses(&saveHouses);
+			freeEdges(&edges);
+
+			return RESULT_FILE_ERR;
+		}
+	}
+
+	int result = readData(source, &saveHouses, &edges); /* try to read in the data */
+
+	if (stdin != source) fclose(source);
 
+	if (RESULT_MALLOC_ERR == result && NULL != edges.spill && ferror(edges.spill)) result = RESULT_EXTERNAL_ERR; /* (a full buffer could not be written) */
+
+	endPhase(STATS_READ, phaseStart);
+	phaseStart = currentMilliseconds();
+
+	if (result != RESULT_OK)
+	{
 		freeSaveHouses(&saveHouses);
 		freeEdges(&edges);
-		freeGraph(&graph2);
 
-		return 1;
+		return result;
 	}
 
-	/* the results are all the saveHouses that are still valid after the second run */
-	for (size_t i = 0; i < graph2.count; i++)
+	if (saveHouses.count > 0)
 	{
-		if (true == graph2.vertices[i].isSaveHouse && graph2.vertices[i].distance <= globalDistance)
+		/* adjust size of savehouses to actual size */
+		uint32_t *temp2 = (uint32_t*)malloc(sizeof(uint32_t) * saveHouses.count);
+
+		if (NULL == temp2)
 		{
-			fprintf(stdout, "%"PRIu32"\n", graph2.vertices[i].id);
-			fflush(stdout);
+			freeSaveHouses(&saveHouses);
+			freeEdges(&edges);
+
+			return RESULT_MALLOC_ERR;
 		}
-	}
 
-	freeSaveHouses(&saveHouses);
-	freeEdges(&edges);
-	freeGraph(&graph2);
+		memcpy(temp2, saveHouses.data, sizeof(uint32_t) * saveHouses.count);
+		free(saveHouses.data);
+		saveHouses.data = temp2;
+		saveHouses.limit = saveHouses.count;
 
-	return 0;
-}
+		if (!radixSortSaveHouses(&saveHouses))
+		{
+			freeSaveHouses(&saveHouses);
+			freeEdges(&edges);
 
-int readData(savehouses_t *__restrict saveHouses, edges_t *__restrict edges)
-{
-	uint32_t last = 0; /* temporary value */
-	bool firstLine = true; /* just to know if we read the first line (the first line is handled differently) */
-	while (1)
+			return RESULT_MALLOC_ERR;
+		}
+
+		dropDuplicateSaveHouses(&saveHouses); /* (an id can be in the input more than once) */
+
+		endPhase(STATS_SORT, phaseStart);
+	}
+	else
 	{
-		char line[65]; /* buffer */
-		char *result = fgets(line, 64, stdin); /* read up to 64 characers (3 numbers in 64 Bit (just to get outoufbounds)) */
+		free(saveHouses.data);
+		saveHouses.data = NULL;
+		saveHouses.count = 0;
+		saveHouses.limit = 0;
 
-		if (NULL == result && feof(stdin)) /* this means that the file ended before any savhouses were found, which is fine */
+		if (!serverMode && NULL == exportPath) /* the answer is empty anyways, so there is no need for a graph */
 		{
-			if (firstLine) return RESULT_INPUT_EMPTY;
+			freeEdges(&edges);
+
 			return RESULT_OK;
 		}
+	}
 
-		if (NULL == result || 0 != ferror(stdin)) return RESULT_INPUT_ERR; /* this checks if any error occured */
+	phaseStart = currentMilliseconds();
 
-		if (line[0] < '0' || line[0] > '9') return RESULT_INPUT_ERR; /* leading white spaces are not allowed */
+	bool built = buildGraph(&saveHouses, &edges, graph); /* this will build a graph like structure from all the edges we have */
 
-		char *startPtr, *endPtr, *distancePtr; /* temporary strings for splitting the input */
+	endPhase(STATS_BUILD, phaseStart);
 
-		errno = 0;
-		uint64_t startID = strtoull(line, &startPtr, 10); /* parse the first number (start points to after the number) */
+	freeSaveHouses(&saveHouses); /* (only if buildGraph did not take them over) */
+	freeEdges(&edges); /* everything we need is in the graph now */
 
-		if (startPtr == line) return RESULT_INPUT_ERR;  /* error */
+	if (!built) return (NULL != externalPath) ? RESULT_EXTERNAL_ERR : RESULT_MALLOC_ERR;
 
-		if (ERANGE == errno || startID >= 4000000000ULL) return RESULT_OUT_OF_RANGE; /* out of range? */
+	return RESULT_OK;
+}
 
-																					 /* only accept \n, use dos2unix or something like that if input has Windows line endings (\r\n) */
-		if (!firstLine && ('\n' == startPtr[0] || 0 == startPtr[0])) /* if the line ends after the first number we entered the savehouse section */
-		{
-			last = (uint32_t)startID; /* save the savehouse for later */
-			break; /* go to savehouse section */
-		}
+int findSaveHouses(graph_t *__restrict graph, const uint32_t startID, const uint32_t endID, const uint64_t limit, savehouses_t *__restrict result)
+{   /* result gets all the savehouses that are on a route from startID to endID (both parts <= limit), sorted */
+	result->count = 0;
+	result->limit = 0;
+	result->data = NULL;
 
-		if (' ' != startPtr[0] || startPtr[1] < '0' || startPtr[1] > '9') return RESULT_INPUT_ERR;
+	uint32_t startIndex = findNode(graph, startID);
+	uint32_t endIndex = findNode(graph, endID);
 
-		errno = 0;
-		uint64_t endID = strtoull(startPtr, &endPtr, 10); /* parse the second number */
+	if (INFINITY32 == startIndex || INFINITY32 == endIndex) return RESULT_OK; /* no edges at those nodes, so no route */
 
-		if (startPtr == endPtr) return RESULT_INPUT_ERR;  /* error */
+	/* calc the distance from the start node to every savehouse and from every savehouse to the end node (same as dijkstra
+	   from the end node on the reversed edges), each search stops once it has all of its targets. with threads both run at
+	   the same time, otherwise the backward one only needs the savehouses the forward one reached */
+	search_t searches[2];
+	double start = currentMilliseconds();
+	size_t words = BITMAP_WORDS(graph->count);
 
-		if (ERANGE == errno || endID >= 4000000000ULL) return RESULT_OUT_OF_RANGE;
+	bool created = createSearch(&searches[0], graph, &graph->out, startIndex, limit);
+	created = createSearch(&searches[1], graph, &graph->in, endIndex, limit) && created;
 
-		if (' ' != endPtr[0] || endPtr[1] < '0' || endPtr[1] > '9') return RESULT_INPUT_ERR;
+	searches[0].targets = graph->saveHouseBits;
+	for (size_t i = 0; i < words; i++) searches[0].targetCount += popCount64(graph->saveHouseBits[i]);
 
-		errno = 0;
-		uint64_t distance = strtoull(endPtr, &distancePtr, 10); /* try to parse the last bit as the distance*/
+	searches[1].targets = graph->saveHouseBits;
+	searches[1].targetCount = searches[0].targetCount;
 
-		if (distancePtr == endPtr) return RESULT_INPUT_ERR;  /* error */
+	bool together = threadCount > 1 && SEARCH_DELTA != searchType; /* (what runSearchPair would do) */
 
-		if (ERANGE == errno || distance >= 4000000000ULL) return RESULT_OUT_OF_RANGE;
+	if (created && together) runSearchPair(searches);
+	else if (created) runSearch(&searches[0]);
 
-		if (0 == distancePtr[0] || '\n' == distancePtr[0]) /* the triple can only be followed by a newline character (or nothing) */
-		{
-			if (firstLine) /* the very first line has a special purpose */
-			{
-				globalStartID = (uint32_t)startID;
-				globalEndID = (uint32_t)endID;
-				globalDistance = distance;
-				firstLine = false;
-			}
-			else /* every other triple is an edge of the graph */
-			{
-				if (distance <= globalDistance) /* filter out edges which are too long anyways */
-				{
-					edge_t newEdge;
-					newEdge.startID = (uint32_t)startID;
-					newEdge.endID = (uint32_t)endID;
-					newEdge.distance = distance;
+	if (created && !together && searches[0].success)
+	{   /* (the forward search keeps only the savehouses it reached) */
+		searches[1].targets = searches[0].reached;
+		searches[1].targetCount = andBitmaps(searches[0].reached, graph->saveHouseBits, graph->saveHouseBits, words);
 
-					if (!insertEdge(edges, &newEdge)) return RESULT_MALLOC_ERR; /* try to insert the edge */
-				}
-			}
-		}
-		else return RESULT_INPUT_ERR;
+		if (0 != searches[1].targetCount) runSearch(&searches[1]);
+		else searches[1].success = true; /* nothing to go back to */
 	}
 
-	if (!insertSaveHouse(saveHouses, last)) return RESULT_MALLOC_ERR; /* the very first savehouse gets parsed by the "edge-algorithm" so we just insert it here*/
-
-	while (1)
+	if (!created || !searches[0].success || !searches[1].success)
 	{
-		/* end when the file is empty */
-		if (feof(stdin)) return RESULT_OK;
+		freeSearch(&searches[0]);
+		freeSearch(&searches[1]);
 
-		char line[25];
-		char *result = fgets(line, 23, stdin); /* read a line (now we are only looking for one number, so buffer is smaller) */
+		return RESULT_MALLOC_ERR;
+	}
 
-		if (NULL == result && feof(stdin)) return RESULT_OK; /* if nothing returned and the file is empty we are finished */
+	countSearch(&searches[0]);
+	countSearch(&searches[1]);
 
-		if (NULL == result || 0 != ferror(stdin)) return RESULT_INPUT_ERR; /* this checks if any error occured */
+	/* the results are all the saveHouses that can be reached from the start and reach the end, the bits of the nodes are in
+	   the order of their ids, so the answer comes out sorted */
+	uint64_t found = andBitmaps(searches[0].reached, searches[1].reached, graph->saveHouseBits, words);
 
-		if (line[0] < '0' || line[0] > '9') return RESULT_INPUT_ERR; /* do not accept leading white spaces */
+	int listed = listSaveHouses(graph, searches[0].reached, found, result);
 
-		char *endPtr;
-		errno = 0;
-		uint64_t saveHouse = strtoull(line, &endPtr, 10); /* try to parse whatever into a number */
+	freeSearch(&searches[0]);
+	freeSearch(&searches[1]);
 
-		if (endPtr == line) return RESULT_INPUT_ERR; /* error */
+	stats.answer = result->count;
+	endPhase(STATS_SEARCH, start);
 
-		if (ERANGE == errno || saveHouse >= 4000000000ULL) return RESULT_OUT_OF_RANGE;
+	return listed;
+}
 
-		if (0 == *endPtr || '\n' == *endPtr) /* the number can only be followed by newline character (or nothing) */
-		{
-			if (!insertSaveHouse(saveHouses, (uint32_t)saveHouse)) return RESULT_MALLOC_ERR; /* try to insert the savehouse */
-		}
-		else return RESULT_INPUT_ERR;
+void runSearchPair(search_t *searches)
+{   /* both only read the graph so they can run at the same time (delta-stepping uses all threads for each search, so those
+	   run one after the other) */
+	if (threadCount > 1 && SEARCH_DELTA != searchType) runParallel(runSearch, searches, sizeof(search_t), 2);
+	else
+	{
+		runSearch(&searches[0]);
+		runSearch(&searches[1]);
 	}
 }
-/*====UTIL ROUTINES============================================================*/
 
+int findSaveHousesBatch(graph_t *__restrict graph, const uint64_t (*queries)[3], const uint32_t count, savehouses_t *__restrict results)
+{   /* the same answers as findSaveHouses for every query (results gets count of them), the queries share both passes over the
+	   edges. a query whose start or end has no edges keeps its lane empty */
+	batch_t batches[2];
+	double start = currentMilliseconds();
 
-/*====EDGE ROUTINES============================================================*/
-bool insertEdge(edges_t *__restrict edges, edge_t *__restrict edge)
-{
-	if (edges->count == edges->limit) /* check if we reached the memory limit */
-	{
-		edges->limit = edges->limit << 1; /* if yes increase limit accordingly */
+	memset(results, 0, sizeof(savehouses_t) * count);
 
-		edge_t *temp = (edge_t*)calloc(edges->limit, sizeof(edge_t)); /* and get new memory in the new size */
+	bool created = createBatch(&batches[0], graph, &graph->out);
+	created = createBatch(&batches[1], graph, &graph->in) && created;
 
-		if (temp == NULL) return false; /* check if that worked */
+	for (uint32_t i = 0; created && i < count; i++)
+	{
+		uint32_t startIndex = findNode(graph, (uint32_t)queries[i][0]);
+		uint32_t endIndex = findNode(graph, (uint32_t)queries[i][1]);
 
-		memcpy(temp, edges->data, sizeof(edge_t) * edges->count); /* copy the old data to the new array */
-		free(edges->data); /* free the old data */
-		edges->data = temp; /* set our pointer to that new array */
-	}
+		if (INFINITY32 == startIndex || INFINITY32 == endIndex) continue; /* no edges at those nodes, so no route */
 
-	edges->data[edges->count] = *edge; /* insert element at the end */
-	edges->count++; /* increase index */
+		batches[0].starts[i] = startIndex;
+		batches[1].starts[i] = endIndex;
+		batches[0].limits[i] = batches[1].limits[i] = (uint32_t)queries[i][2]; /* (< MAX_ID) */
+	}
 
-	return true;
-}
+	if (created)
+	{
+		if (threadCount > 1) runParallel(runBatch, batches, sizeof(batch_t), 2);
+		else
+		{
+			runBatch(&batches[0]);
+			runBatch(&batches[1]);
+		}
+	}
 
-uint32_t findFirstEdge(edges_t *edges, uint32_t startID)
-{
-	if (0 == edges->count) return INFINITY32;
+	int result = (created && batches[0].success && batches[1].success) ? RESULT_OK : RESULT_MALLOC_ERR;
 
-	uint32_t left = 0;
-	uint32_t right = edges->count - 1;
+	/* a savehouse is the answer to every lane it is reached in from both sides, the bits go in the order of the ids */
+	size_t words = BITMAP_WORDS(graph->count);
 
-	while (left <= right && right < edges->count)
+	for (size_t i = 0; RESULT_OK == result && i < words; i++)
 	{
-		uint32_t middle = left + ((right - left) / 2);
-		if (edges->data[middle].startID > startID) right = middle - 1;
-		else if (edges->data[middle].startID < startID) left = middle + 1;
-		else
+		for (uint64_t word = graph->saveHouseBits[i]; 0 != word; word &= word - 1)
 		{
-			while (middle > 0 && edges->data[middle - 1].startID == startID) middle--;
-			return middle;
+			size_t index = (i << 6) | countTrailingZeros64(word);
+			const uint32_t *forward = &batches[0].lanes[index * BATCH_LANES];
+			const uint32_t *backward = &batches[1].lanes[index * BATCH_LANES];
+
+			for (uint32_t lane = 0; lane < count; lane++)
+			{
+				if (INFINITY32 != forward[lane] && INFINITY32 != backward[lane] && !insertSaveHouse(&results[lane], graph->ids[index])) result = RESULT_MALLOC_ERR;
+			}
 		}
 	}
 
-	return INFINITY32;
+	for (uint32_t i = 0; i < 2 && created; i++)
+	{
+		stats.searches++;
+		stats.pops += batches[i].pops;
+		stats.relaxed += batches[i].relaxed;
+	}
+
+	freeBatch(&batches[0]);
+	freeBatch(&batches[1]);
+	endPhase(STATS_SEARCH, start);
+
+	return result;
 }
-/*====EDGE ROUTINES============================================================*/
+
+bool answerIsolated(graph_t *__restrict graph, const uint32_t startID, const uint32_t endID, savehouses_t *__restrict answer)
+{   /* a node without edges is not in the graph, but it can still be the answer to itself (false only if out of memory) */
+	if (startID == endID && INFINITY32 == findNode(graph, startID) && checkSaveHouse(&graph->saveHouses, startID)) return insertSaveHouse(answer, startID);
+
+	return true;
+}
+
+int listSaveHouses(graph_t *__restrict graph, const uint64_t *__restrict bits, const uint64_t found, savehouses_t *__restrict result)
+{   /* result gets the id of every set bit, found is how many there are (andBitmaps counted them) */
+	result->count = 0;
+	result->limit = 0;
+	result->data = NULL;
+
+	if (found > 0)
+	{
+		result->data = (uint32_t*)malloc(sizeof(uint32_t) * found);
+
+		if (NULL == result->data) return RESULT_MALLOC_ERR;
+
+		result->limit = (uint32_t)found;
+	}
+
+	size_t words = BITMAP_WORDS(graph->count);
+
+	for (size_t i = 0; i < words; i++)
+	{
+		for (uint64_t word = bits[i]; 0 != word; word &= word - 1) /* (clears the lowest bit) */
+		{
+			result->data[result->count++] = graph->ids[(i << 6) | countTrailingZeros64(word)];
+		}
+	}
+
+	return RESULT_OK;
+}
+
+bool parseArguments(int argc, char **argv)
+{
+	bool memoryGiven = false;
+
+#if POSIX_AVAILABLE
+	long online = sysconf(_SC_NPROCESSORS_ONLN); /* by default use every core */
+	if (online > 0) threadCount = (online > MAX_THREADS) ? MAX_THREADS : (uint32_t)online;
+#endif
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (0 == strncmp(argv[i], "--threads=", 10))
+		{
+			char *end;
+			unsigned long value = strtoul(argv[i] + 10, &end, 10);
+
+			if (end == argv[i] + 10 || 0 != *end || 0 == value || value > MAX_THREADS) return false;
+
+			threadCount = (uint32_t)value;
+		}
+		else if (0 == strncmp(argv[i], "--input=", 8) && 0 != argv[i][8]) inputPath = argv[i] + 8;
+		else if (0 == strcmp(argv[i], "--serve")) serverMode = true;
+		else if (0 == strcmp(argv[i], "--compress")) compressMode = true;
+		else if (0 == strcmp(argv[i], "--stats")) statsMode = true;
+		else if (0 == strncmp(argv[i], "--stats=", 8) && 0 != argv[i][8])
+		{
+			statsPath = argv[i] + 8;
+			statsMode = true;
+		}
+		else if (0 == strncmp(argv[i], "--external=", 11) && 0 != argv[i][11]) externalPath = argv[i] + 11;
+		else if (0 == strncmp(argv[i], "--memory=", 9))
+		{
+			char *end;
+			unsigned long value = strtoul(argv[i] + 9, &end, 10);
+
+			if (end == argv[i] + 9 || 0 != *end || 0 == value || value > EXTERNAL_MEMORY_MAX) return false;
+
+			memoryBudget = (uint64_t)value << 20;
+			memoryGiven = true;
+		}
+		else if (0 == strncmp(argv[i], "--export=", 9) && 0 != argv[i][9]) exportPath = argv[i] + 9;
+		else if (0 == strncmp(argv[i], "--snapshot=", 11) && 0 != argv[i][11]) snapshotPath = argv[i] + 11;
+		else if (0 == strncmp(argv[i], "--socket=", 9) && 0 != argv[i][9])
+		{
+			socketPath = argv[i] + 9;
+			serverMode = true;
+		}
+		else if (0 == strncmp(argv[i], "--delta=", 8))
+		{
+			char *end;
+			unsigned long long value = strtoull(argv[i] + 8, &end, 10);
+
+			if (end == argv[i] + 8 || 0 != *end || 0 == value || value >= MAX_ID) return false;
+
+			deltaValue = value;
+		}
+		else if (0 == strcmp(argv[i], "--search=dijkstra")) searchType = SEARCH_DIJKSTRA;
+		else if (0 == strcmp(argv[i], "--search=delta")) searchType = SEARCH_DELTA;
+		else if (0 == strcmp(argv[i], "--search=hierarchy")) searchType = SEARCH_HIERARCHY;
+		else if (0 == strcmp(argv[i], "--queue=auto")) queueType = QUEUE_AUTO;
+		else if (0 == strcmp(argv[i], "--queue=binary")) queueType = QUEUE_BINARY;
+		else if (0 == strcmp(argv[i], "--queue=radix")) queueType = QUEUE_RADIX;
+		else if (0 == strcmp(argv[i], "--queue=bucket")) queueType = QUEUE_BUCKET;
+		else return false;
+	}
+
+	if (serverMode && NULL == socketPath && NULL == inputPath && NULL == snapshotPath) return false; /* stdin can not be the graph and the queries */
+	if (NULL != snapshotPath && (NULL != inputPath || NULL != exportPath)) return false; /* a snapshot already is the graph */
+	if (compressMode && (serverMode || NULL != exportPath || SEARCH_DIJKSTRA != searchType)) return false; /* those need the blocks */
+	if (NULL != externalPath && (serverMode || NULL != exportPath || NULL != snapshotPath || compressMode || SEARCH_DIJKSTRA != searchType)) return false; /* so do those */
+	if (memoryGiven && NULL == externalPath) return false; /* (the budget is only for --external) */
+
+	return true;
+}
+
+double currentMilliseconds(void)
+{
+	struct timespec time;
+	timespec_get(&time, TIME_UTC); /* C11, so this works with msvc too */
+
+	return (double)time.tv_sec * 1000.0 + (double)time.tv_nsec / 1000000.0;
+}
+
+static inline void endPhase(const uint32_t phase, const double start)
+{   /* one clock read per phase, so it is always on */
+	stats.phases[phase] += currentMilliseconds() - start;
+}
+
+void countSearch(const search_t *search)
+{
+	stats.searches++;
+	stats.pops += search->pops;
+	stats.relaxed += search->relaxed;
+	stats.pushes += search->pushes;
+	stats.decreaseKeys += search->decreaseKeys;
+}
+
+bool writeStats(const int code)
+{   /* one JSON object on one line, so it can be scraped as it is. peak_rss_bytes is the peak resident set size (RSS, ru_maxrss), not what was allocated */
+	const char *phaseNames[STATS_PHASES] = { "read", "sort", "build", "hierarchy", "compress", "search", "output" };
+	const char *searchNames[] = { "dijkstra", "delta", "hierarchy" };
+	const char *queueNames[] = { "auto", "binary", "radix", "bucket" };
+	uint64_t peak = 0;
+
+#if POSIX_AVAILABLE
+	struct rusage usage;
+	if (0 == getrusage(RUSAGE_SELF, &usage)) peak = (uint64_t)usage.ru_maxrss * STATS_RSS_UNIT;
+#endif
+
+	FILE *out = (NULL != statsPath) ? fopen(statsPath, "w") : stderr;
+
+	if (NULL == out) return false;
+
+	fprintf(out, "{\"exit\":%d,\"threads\":%"PRIu32",\"search\":\"%s\",\"queue\":\"%s\",\"phases_ms\":{", code, threadCount,
+		searchNames[searchType], queueNames[queueType]);
+
+	for (uint32_t i = 0; i < STATS_PHASES; i++) fprintf(out, "%s\"%s\":%.3f", (0 == i) ? "" : ",", phaseNames[i], stats.phases[i]);
+
+	fprintf(out, "},\"total_ms\":%.3f,\"nodes\":%"PRIu64",\"edges\":%"PRIu64",\"searches\":%"PRIu64",\"pops\":%"PRIu64",\"pushes\":%"PRIu64","
+		"\"decrease_keys\":%"PRIu64",\"relaxed_edges\":%"PRIu64",\"find_node_calls\":%"PRIu64",\"answer\":%"PRIu64",\"peak_rss_bytes\":%"PRIu64"}\n",
+		stats.total, stats.nodes, stats.edges, stats.searches, stats.pops, stats.pushes, stats.decreaseKeys, stats.relaxed,
+		stats.findNodeCalls, stats.answer, peak);
+
+	bool written = !ferror(out);
+
+	if (stderr != out) written = (0 == fclose(out)) && written;
+
+	return written;
+}
+
+int parseBinaryInput(input_t *__restrict input, savehouses_t *__restrict saveHouses, edges_t *__restrict edges)
+{
+	const char *record = peekInput(input, sizeof(edgesHeader_t));
+
+	if (NULL == record) return (RESULT_OK != input->error) ? input->error : RESULT_INPUT_ERR; /* cut off in the header */
+
+	edgesHeader_t header;
+	memcpy(&header, record, sizeof(header)); /* the window has no alignment, so everything is copied out */
+	input->position += sizeof(header);
+
+	if (EDGES_VERSION != header.version || EDGES_BYTE_ORDER != header.byteOrder) return RESULT_INPUT_ERR;
+
+	if (header.startID >= MAX_ID || header.endID >= MAX_ID || header.distance >= MAX_ID) return RESULT_OUT_OF_RANGE;
+
+	globalStartID = header.startID;
+	globalEndID = header.endID;
+	globalDistance = header.distance;
+
+	while (1)
+	{
+		record = peekInput(input, EDGES_RECORD_SIZE);
+
+		if (NULL == record) return (RESULT_OK != input->error) ? input->error : RESULT_INPUT_ERR; /* the end marker is missing */
+
+		uint32_t triple[3];
+		memcpy(triple, record, EDGES_RECORD_SIZE);
+		input->position += EDGES_RECORD_SIZE;
+
+		if (EDGES_END == triple[0] && EDGES_END == triple[1] && EDGES_END == triple[2]) break;
+
+		if (triple[0] >= MAX_ID || triple[1] >= MAX_ID || triple[2] >= MAX_ID) return RESULT_OUT_OF_RANGE;
+
+		if (triple[2] <= globalDistance || serverMode || NULL != exportPath) /* the same filter as for the text */
+		{
+			if (!insertEdge(edges, triple[0], triple[1], triple[2])) return RESULT_MALLOC_ERR;
+		}
+	}
+
+	while (NULL != (record = peekInput(input, sizeof(uint32_t))))
+	{
+		uint32_t saveHouse;
+		memcpy(&saveHouse, record, sizeof(saveHouse));
+		input->position += sizeof(saveHouse);
+
+		if (saveHouse >= MAX_ID) return RESULT_OUT_OF_RANGE;
+
+		if (!insertSaveHouse(saveHouses, saveHouse)) return RESULT_MALLOC_ERR;
+	}
+
+	if (RESULT_OK != input->error) return input->error;
+
+	return (input->position == input->size) ? RESULT_OK : RESULT_INPUT_ERR; /* a few bytes too many or too few */
+}
+
+int readData(FILE *__restrict file, savehouses_t *__restrict saveHouses, edges_t *__restrict edges)
+{
+	input_t input;
+	if (!openInput(&input, file)) return RESULT_MALLOC_ERR;
+
+	/* a mapped input tells us how big it is, so the node dictionary does not have to grow so often on the way (the size says
+	   nothing about how many of the ids repeat, so only up to a limit, and not at all if the edges have to fit into --memory) */
+	size_t reserve = (input.size - input.position) / BYTES_PER_NODE;
+
+	if (reserve > NODE_MAP_RESERVE_LIMIT) reserve = NODE_MAP_RESERVE_LIMIT;
+	if (NULL != edges->spill) reserve = 0;
+
+	if (!reserveNodes(&edges->nodes, reserve))
+	{
+		closeInput(&input);
+		return RESULT_MALLOC_ERR;
+	}
+
+	int result = parseInput(&input, saveHouses, edges);
+
+	closeInput(&input);
+
+	return result;
+}
+
+int parseInput(input_t *__restrict input, savehouses_t *__restrict saveHouses, edges_t *__restrict edges)
+{
+	const char *magic = peekInput(input, sizeof(EDGES_MAGIC)); /* no text starts with a 0 byte, so this can not be a text input */
+
+	if (NULL != magic && 0 == memcmp(magic, EDGES_MAGIC, sizeof(EDGES_MAGIC))) return parseBinaryInput(input, saveHouses, edges);
+
+	if (RESULT_OK != input->error) return input->error;
+
+	bool firstLine = true; /* just to know if we read the first line (the first line is handled differently) */
+	const char *line, *lineEnd;
+	while (1)
+	{
+		line = nextLine(input, &lineEnd);
+
+		if (NULL == line) /* this means that the file ended before any savhouses were found, which is fine */
+		{
+			if (RESULT_OK != input->error) return input->error; /* the buffer could not grow or reading failed */
+			if (firstLine) return RESULT_INPUT_EMPTY;
+			return RESULT_OK;
+		}
+
+		uint64_t triple[3];
+		int result = parseTriple(line, lineEnd, input->data + input->size, triple);
+
+		if (RESULT_SINGLE_NUMBER == result && !firstLine) break; /* if the line ends after the first number we entered the savehouse section */
+
+		if (RESULT_OK != result) return (RESULT_SINGLE_NUMBER == result) ? RESULT_INPUT_ERR : result;
+
+		if (firstLine) /* the very first line has a special purpose */
+		{
+			globalStartID = (uint32_t)triple[0];
+			globalEndID = (uint32_t)triple[1];
+			globalDistance = triple[2];
+			firstLine = false;
+
+			/* with the distance known, the edges of a big mapped input can be parsed in parts (not for --external, its buffer may not grow) */
+			if (0 != input->mappedSize && threadCount > 1 && NULL == edges->spill && input->size - input->position >= PARALLEL_PARSE_MIN)
+			{
+				return parseParallel(input, saveHouses, edges);
+			}
+		}
+		else if (triple[2] <= globalDistance || serverMode || NULL != exportPath) /* every other triple is an edge of the graph, filter out edges which are too long anyways (not in server mode or for a snapshot, every query has its own distance) */
+		{
+			if (!insertEdge(edges, (uint32_t)triple[0], (uint32_t)triple[1], triple[2])) return RESULT_MALLOC_ERR; /* try to insert the edge */
+		}
+	}
+
+	return parseSaveHouses(input, saveHouses, line, lineEnd);
+}
+
+int parseSaveHouses(input_t *__restrict input, savehouses_t *__restrict saveHouses, const char *line, const char *lineEnd)
+{   /* the very first savehouse gets parsed by the "edge-algorithm" so we just parse it again here */
+	while (NULL != line)
+	{
+		if (line == lineEnd || !IS_DIGIT(line[0])) return RESULT_INPUT_ERR; /* do not accept leading white spaces (or empty lines) */
+
+		uint64_t saveHouse;
+		const char *cursor = parseNumber(line, input->data + input->size, &saveHouse); /* try to parse whatever into a number */
+
+		if (saveHouse >= MAX_ID) return RESULT_OUT_OF_RANGE;
+
+		if (cursor != lineEnd) return RESULT_INPUT_ERR; /* the number can only be followed by newline character (or nothing) */
+
+		if (!insertSaveHouse(saveHouses, (uint32_t)saveHouse)) return RESULT_MALLOC_ERR; /* try to insert the savehouse */
+
+		line = nextLine(input, &lineEnd); /* end when the file is empty */
+	}
+
+	return input->error;
+}
+
+static inline int parseTriple(const char *line, const char *lineEnd, const char *limit, uint64_t *triple)
+{   /* limit is where the scanner has to stop looking ahead, digit runs stop at '\n' anyways */
+	if (line == lineEnd || !IS_DIGIT(line[0])) return RESULT_INPUT_ERR; /* leading white spaces are not allowed */
+
+	const char *cursor = parseNumber(line, limit, &triple[0]); /* parse the first number (cursor points to after the number) */
+
+	if (triple[0] >= MAX_ID) return RESULT_OUT_OF_RANGE; /* out of range? */
+
+	/* only accept \n, use dos2unix or something like that if input has Windows line endings (\r\n) */
+	if (cursor == lineEnd) return RESULT_SINGLE_NUMBER;
+
+	if (lineEnd - cursor < 2 || ' ' != cursor[0] || !IS_DIGIT(cursor[1])) return RESULT_INPUT_ERR;
+
+	cursor = parseNumber(cursor + 1, limit, &triple[1]); /* parse the second number */
+
+	if (triple[1] >= MAX_ID) return RESULT_OUT_OF_RANGE;
+
+	if (lineEnd - cursor < 2 || ' ' != cursor[0] || !IS_DIGIT(cursor[1])) return RESULT_INPUT_ERR;
+
+	cursor = parseNumber(cursor + 1, limit, &triple[2]); /* try to parse the last bit as the distance*/
+
+	if (triple[2] >= MAX_ID) return RESULT_OUT_OF_RANGE;
+
+	if (cursor != lineEnd) return RESULT_INPUT_ERR; /* the triple can only be followed by a newline character (or nothing) */
+
+	return RESULT_OK;
+}
+
+int parseParallel(input_t *__restrict input, savehouses_t *__restrict saveHouses, edges_t *__restrict edges)
+{   /* every thread gets a part that starts right after a newline, the parts are put together in the order of the input,
+	 * so the edges (and the indices of the nodes) are the same as if one thread had read them */
+	parseJob_t jobs[MAX_THREADS];
+	const char *begin = input->data + input->position;
+	const char *end = input->data + input->size;
+	size_t length = input->size - input->position;
+
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		jobs[i].first = (0 == i) ? begin : jobs[i - 1].last;
+		jobs[i].limit = end;
+		jobs[i].data = NULL;
+		jobs[i].count = 0;
+		jobs[i].capacity = 0;
+		jobs[i].saveHouses = NULL;
+		jobs[i].weight = INFINITY32;
+		jobs[i].result = RESULT_OK;
+
+		const char *last = (i + 1 == threadCount) ? end : begin + length / threadCount * (i + 1);
+
+		if (last < jobs[i].first) last = jobs[i].first; /* (the part before took a very long line) */
+
+		if (last < end) /* the part ends with the line it cuts */
+		{
+			const char *newline = (const char*)memchr(last, '\n', (size_t)(end - last));
+			last = (NULL == newline) ? end : newline + 1;
+		}
+
+		jobs[i].last = last;
+	}
+
+	runParallel(parsePart, jobs, sizeof(parseJob_t), threadCount);
+
+	uint64_t total = 0; /* the parts up to the one with the first error or the savehouses count */
+	uint32_t parts = 0;
+	int result = RESULT_OK;
+	const char *saveHouseLine = NULL;
+
+	while (parts < threadCount)
+	{
+		if (INFINITY32 != jobs[parts].weight) edges->weight = mergeWeight(edges->weight, jobs[parts].weight);
+
+		total += jobs[parts].count;
+		result = jobs[parts].result;
+		saveHouseLine = jobs[parts].saveHouses;
+		parts++;
+
+		if (RESULT_OK != result || NULL != saveHouseLine) break; /* the lines after that are not edges anymore (or an error came first) */
+	}
+
+	if (RESULT_OK == result && total > UINT32_MAX) result = RESULT_MALLOC_ERR;
+
+	edge_t *data = NULL;
+
+	if (RESULT_OK == result)
+	{   /* the buffer of the first part grows to hold all of them, every other part gets copied behind it once */
+		data = (edge_t*)realloc(jobs[0].data, sizeof(edge_t) * (size_t)((0 == total) ? 1 : total));
+
+		if (NULL == data) result = RESULT_MALLOC_ERR;
+		else jobs[0].data = NULL;
+	}
+
+	size_t count = (NULL == data) ? 0 : jobs[0].count;
+
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		if (NULL == jobs[i].data) continue;
+
+		if (NULL != data && i < parts)
+		{
+			memcpy(data + count, jobs[i].data, sizeof(edge_t) * jobs[i].count);
+			count += jobs[i].count;
+		}
+
+		free(jobs[i].data);
+	}
+
+	if (RESULT_OK != result)
+	{
+		if (NULL != data) free(data);
+
+		return result;
+	}
+
+	free(edges->data); /* (the first line is not an edge, so there is nothing in it yet) */
+	edges->data = data;
+	edges->count = (uint32_t)total;
+	edges->limit = (uint32_t)((0 == total) ? 1 : total);
+
+	for (size_t i = 0; i < count; i++) /* the ids get their indices in the order of the input (one thread, the dictionary grows) */
+	{
+		data[i].start = mapNode(&edges->nodes, data[i].start);
+		data[i].end = mapNode(&edges->nodes, data[i].end);
+
+		if (INFINITY32 == data[i].start || INFINITY32 == data[i].end) return RESULT_MALLOC_ERR;
+	}
+
+	if (NULL == saveHouseLine) /* the input ended without savehouses */
+	{
+		input->position = input->size;
+		return RESULT_OK;
+	}
+
+	input->position = (size_t)(saveHouseLine - input->data);
+
+	const char *line, *lineEnd;
+	line = nextLine(input, &lineEnd);
+
+	return parseSaveHouses(input, saveHouses, line, lineEnd);
+}
+
+void *parsePart(void *argument)
+{   /* the same checks as parseInput, an edge only gets its ids here, stops at the first error or savehouse */
+	parseJob_t *job = (parseJob_t*)argument;
+	const char *line = job->first;
+
+	while (line < job->last)
+	{
+		const char *lineEnd = (const char*)memchr(line, '\n', (size_t)(job->last - line));
+		if (NULL == lineEnd) lineEnd = job->last; /* the last line does not need a newline */
+
+		uint64_t triple[3];
+		int result = parseTriple(line, lineEnd, job->limit, triple);
+
+		if (RESULT_SINGLE_NUMBER == result)
+		{
+			job->saveHouses = line;
+			break;
+		}
+
+		if (RESULT_OK != result)
+		{
+			job->result = result;
+			break;
+		}
+
+		if (triple[2] <= globalDistance || serverMode || NULL != exportPath) /* the same filter as parseInput */
+		{
+			if (job->count == job->capacity)
+			{
+				size_t capacity = (0 == job->capacity) ? (size_t)(job->last - job->first) / BYTES_PER_EDGE + MEMORY_START_SIZE : (size_t)job->capacity << 1;
+				edge_t *temp = (capacity > UINT32_MAX) ? NULL : (edge_t*)realloc(job->data, sizeof(edge_t) * capacity);
+
+				if (NULL == temp)
+				{
+					job->result = RESULT_MALLOC_ERR;
+					break;
+				}
+
+				job->data = temp;
+				job->capacity = (uint32_t)capacity;
+			}
+
+			job->data[job->count].start = (uint32_t)triple[0];
+			job->data[job->count].end = (uint32_t)triple[1];
+			job->data[job->count].distance = triple[2];
+			job->count++;
+			job->weight = mergeWeight(job->weight, (uint32_t)triple[2]);
+		}
+
+		line = lineEnd + 1;
+	}
+
+	return NULL;
+}
+/*====UTIL ROUTINES============================================================*/
+
+
+/*====INPUT ROUTINES===========================================================*/
+bool openInput(input_t *__restrict input, FILE *__restrict file)
+{
+	input->data = NULL;
+	input->size = 0;
+	input->position = 0;
+	input->buffer = NULL;
+	input->capacity = 0;
+	input->mappedSize = 0;
+	input->file = file;
+	input->eof = false;
+	input->error = RESULT_OK;
+
+#if POSIX_AVAILABLE
+	struct stat info;
+	int fd = fileno(file);
+
+	/* regular files (./loesung < file) get mapped, then there is no copying at all */
+	if (0 == fstat(fd, &info) && S_ISREG(info.st_mode))
+	{
+		off_t offset = lseek(fd, 0, SEEK_CUR); /* someone might have read from the file before us */
+
+		if (offset >= 0 && offset >= info.st_size) /* nothing left (mmap does not like a length of 0) */
+		{
+			input->eof = true;
+			return true;
+		}
+
+		if (offset >= 0)
+		{
+			void *mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (MAP_FAILED != mapped)
+			{
+				posix_madvise(mapped, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL); /* just a hint, so ignore errors */
+
+				input->data = (const char*)mapped;
+				input->size = (size_t)info.st_size;
+				input->position = (size_t)offset;
+				input->mappedSize = (size_t)info.st_size;
+				input->eof = true;
+
+				return true;
+			}
+		}
+	}
+#endif
+
+	/* pipes (or if mapping failed) are read in big blocks */
+	input->capacity = INPUT_BLOCK_SIZE;
+	input->buffer = (char*)malloc(input->capacity);
+
+	if (NULL == input->buffer) return false;
+
+	input->data = input->buffer;
+
+	return true;
+}
+
+bool refillInput(input_t *input)
+{
+	if (input->eof) return false;
+
+	size_t rest = input->size - input->position; /* the beginning of a line which did not fit in anymore */
+
+	if (rest == input->capacity) /* a single line fills the whole buffer, so we need a bigger one */
+	{
+		char *temp = (char*)realloc(input->buffer, input->capacity << 1);
+
+		if (NULL == temp)
+		{
+			input->error = RESULT_MALLOC_ERR;
+			return false;
+		}
+
+		input->buffer = temp;
+		input->capacity = input->capacity << 1;
+	}
+	else
+	{
+		memmove(input->buffer, input->buffer + input->position, rest); /* move the rest to the front */
+	}
+
+	input->data = input->buffer;
+	input->size = rest;
+	input->position = 0;
+
+	size_t got = fread(input->buffer + rest, 1, input->capacity - rest, input->file); /* read the next block */
+	input->size += got;
+
+	if (got < input->capacity - rest)
+	{
+		if (0 != ferror(input->file))
+		{
+			input->error = RESULT_INPUT_ERR;
+			return false;
+		}
+
+		input->eof = true; /* short read without error means the end of the input */
+	}
+
+	return true;
+}
+
+const char *nextLine(input_t *__restrict input, const char **__restrict lineEnd)
+{
+	size_t searched = 0; /* how much of the rest we allready know to be without newline */
+	while (1)
+	{
+		const char *line = input->data + input->position;
+		size_t rest = input->size - input->position;
+
+		/* memchr is vectorized in every libc we care about, so this is the simd newline scan */
+		const char *newline = (rest > searched) ? (const char*)memchr(line + searched, '\n', rest - searched) : NULL; /* (data is NULL for an empty input) */
+
+		if (NULL != newline)
+		{
+			*lineEnd = newline;
+			input->position += (size_t)(newline - line) + 1;
+
+			return line;
+		}
+
+		if (input->eof) /* the last line does not need a newline */
+		{
+			if (0 == rest) return NULL;
+
+			*lineEnd = line + rest;
+			input->position = input->size;
+
+			return line;
+		}
+
+		searched = rest;
+
+		if (!refillInput(input)) return NULL; /* error (see input->error) */
+	}
+}
+
+const char *peekInput(input_t *input, const size_t size)
+{
+	while (input->size - input->position < size)
+	{
+		if (!refillInput(input)) return NULL; /* end of the input or error (see input->error) */
+	}
+
+	return input->data + input->position;
+}
+
+void closeInput(input_t *input)
+{
+#if POSIX_AVAILABLE
+	if (0 != input->mappedSize) munmap((void*)input->data, input->mappedSize);
+#endif
+
+	if (NULL != input->buffer) free(input->buffer);
+
+	input->data = NULL;
+	input->buffer = NULL;
+	input->size = 0;
+	input->mappedSize = 0;
+}
+
+static inline const char *parseNumber(const char *text, const char *limit, uint64_t *value)
+{   /* text has to start with a digit, limit is where the readable memory ends */
+	const char *cursor = text;
+	bool found = false;
+
+#if SIMD_AVAILABLE
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i nine = _mm_set1_epi8(9);
+
+	while (limit - cursor >= 16) /* look at 16 characters at once to find the end of the number */
+	{
+		__m128i chunk = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)cursor), zero);
+		__m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(chunk, nine), chunk); /* 0xFF where 0 <= c - '0' <= 9 */
+		uint32_t mask = ~(uint32_t)_mm_movemask_epi8(digits) & 0xFFFF; /* bits of the non digits */
+
+		if (0 != mask)
+		{
+			cursor += countTrailingZeros(mask);
+			found = true;
+			break;
+		}
+
+		cursor += 16;
+	}
+#endif
+
+	if (!found) while (cursor < limit && IS_DIGIT(*cursor)) cursor++; /* the last few bytes (or no sse2) */
+
+	while (text < cursor - 1 && '0' == *text) text++; /* leading zeros do not count */
+
+	if (cursor - text > 10) /* anything with more digits is too big anyways (strtoull might not even be able to hold it) */
+	{
+		*value = UINT64_MAX;
+		return cursor;
+	}
+
+	uint64_t result = 0;
+	for (; text < cursor; text++) result = result * 10 + (uint64_t)(*text - '0');
+
+	*value = result;
+
+	return cursor;
+}
+/*====INPUT ROUTINES===========================================================*/
+
+
+/*====SERVER ROUTINES==========================================================*/
+bool parseNumbers(const char *line, uint64_t *numbers, const uint32_t count)
+{   /* count numbers separated by single spaces, like the first line of the input */
+	const char *end = line + strlen(line);
+
+	while (end > line && ('\n' == end[-1] || '\r' == end[-1])) end--; /* clients may send \r\n */
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (0 != i)
+		{
+			if (line >= end || ' ' != *line) return false;
+			line++;
+		}
+
+		if (line >= end || !IS_DIGIT(*line)) return false;
+
+		line = parseNumber(line, end, &numbers[i]);
+
+		if (numbers[i] >= MAX_ID) return false;
+	}
+
+	return line == end;
+}
+
+int serveQueries(graph_t *__restrict graph, watch_t *__restrict watch, FILE *in, FILE *out)
+{   /* every line "start end distance" is answered with "count microseconds id id ...", "batch n" reads n of them and answers them
+	   together (serveBatch), other lines are commands (serveCommand) */
+	char line[QUERY_LINE_SIZE];
+
+	while (NULL != fgets(line, QUERY_LINE_SIZE, in))
+	{
+		uint64_t query[3];
+
+		if (NULL == strchr(line, '\n') && !feof(in)) /* too long, skip the rest of it */
+		{
+			int c;
+			while (EOF != (c = fgetc(in)) && '\n' != c);
+
+			fputs("error query too long\n", out);
+			fflush(out);
+			continue;
+		}
+
+		if (0 == strncmp(line, "quit", 4) && parseNumbers(line + 4, query, 0)) break; /* the whole line, "quit 5" is no command */
+
+		if (0 == strncmp(line, "batch ", 6))
+		{
+			int result = serveBatch(graph, line, in, out);
+
+			if (RESULT_OK != result) return result;
+
+			continue;
+		}
+
+		if (!IS_DIGIT(line[0])) /* an update or something about the watched query */
+		{
+			int result = serveCommand(graph, watch, line, out);
+
+			if (RESULT_OK != result) return result;
+
+			continue;
+		}
+
+		if (!parseNumbers(line, query, 3))
+		{
+			fputs("error expected: start end distance\n", out);
+			fflush(out);
+			continue;
+		}
+
+		double start = currentMilliseconds();
+
+		savehouses_t answer = { 0, 0, NULL };
+		int result = RESULT_OK;
+
+		if (0 != graph->out.addedCount && !mergeAddedEdges(graph)) result = RESULT_MALLOC_ERR; /* the searches only look at the blocks */
+
+		if (RESULT_OK == result) result = findSaveHouses(graph, (uint32_t)query[0], (uint32_t)query[1], query[2], &answer);
+
+		if (RESULT_OK == result && !answerIsolated(graph, (uint32_t)query[0], (uint32_t)query[1], &answer)) result = RESULT_MALLOC_ERR;
+
+		if (RESULT_OK != result)
+		{
+			fputs(mallocZeroException, stderr);
+			fputs("error out of memory\n", out);
+			fflush(out);
+
+			freeSaveHouses(&answer);
+
+			return result;
+		}
+
+		printAnswer(out, &answer, currentMilliseconds() - start);
+
+		freeSaveHouses(&answer);
+	}
+
+	return RESULT_OK;
+}
+
+int serveCommand(graph_t *__restrict graph, watch_t *__restrict watch, const char *line, FILE *out)
+{   /* "watch start end distance" keeps that query and answers it, "answer" answers it again with the graph as it is now.
+	   "add-edge from to weight", "remove-edge from to", "set-weight from to weight", "add-savehouse id" and "remove-savehouse id"
+	   change the graph (and repair the kept query), they are answered with "ok nodes microseconds". the edge updates only work
+	   between nodes that had edges in the input: the node indices, the bitmaps and the searches are all sized for those, so a
+	   new id is an error line (a savehouse can be any id). only an allocation that failed ends the server, everything else is
+	   an error line */
+	uint64_t numbers[3];
+	double start = currentMilliseconds();
+	int result = RESULT_OK;
+	savehouses_t answer = { 0, 0, NULL };
+	const char *error = NULL;
+	bool answered = false; /* watch and answer print the savehouses, the updates only ok */
+
+	if (0 == strncmp(line, "watch ", 6) && parseNumbers(line + 6, numbers, 3))
+	{
+		result = startWatch(graph, watch, (uint32_t)numbers[0], (uint32_t)numbers[1], numbers[2]);
+		answered = true;
+
+		if (RESULT_INPUT_ERR == result) error = "error unknown node\n"; /* the kept query needs its nodes */
+		if (RESULT_OK == result) result = answerWatch(graph, watch, &answer);
+	}
+	else if (0 == strncmp(line, "answer", 6) && parseNumbers(line + 6, numbers, 0))
+	{
+		answered = true;
+
+		if (watch->active) result = answerWatch(graph, watch, &answer);
+		else error = "error nothing watched\n";
+	}
+	else if ((0 == strncmp(line, "add-edge ", 9) && parseNumbers(line + 9, numbers, 3)) ||
+		(0 == strncmp(line, "remove-edge ", 12) && parseNumbers(line + 12, numbers, 2)) ||
+		(0 == strncmp(line, "set-weight ", 11) && parseNumbers(line + 11, numbers, 3)))
+	{
+		uint32_t type = ('a' == line[0]) ? UPDATE_ADD_EDGE : ('r' == line[0]) ? UPDATE_REMOVE_EDGE : UPDATE_SET_WEIGHT;
+		uint32_t from = findNode(graph, (uint32_t)numbers[0]), to = findNode(graph, (uint32_t)numbers[1]);
+
+		if (INFINITY32 == from || INFINITY32 == to) error = "error unknown node, updates can not add nodes\n"; /* the node indices are fixed */
+		else
+		{
+			result = updateEdges(graph, watch, type, from, to, (UPDATE_REMOVE_EDGE == type) ? EDGE_REMOVED : (uint32_t)numbers[2]);
+
+			if (RESULT_INPUT_ERR == result) error = "error no such edge\n";
+		}
+	}
+	else if ((0 == strncmp(line, "add-savehouse ", 14) && parseNumbers(line + 14, numbers, 1)) ||
+		(0 == strncmp(line, "remove-savehouse ", 17) && parseNumbers(line + 17, numbers, 1)))
+	{
+		if (!updateSaveHouse(graph, (uint32_t)numbers[0], 'a' == line[0])) result = RESULT_MALLOC_ERR;
+
+		if (watch->active) watch->touched = 0; /* the answer reads the bits, nothing to repair */
+	}
+	else error = "error expected: start end distance or a command\n";
+
+	if (NULL != error)
+	{
+		fputs(error, out);
+		fflush(out);
+
+		return RESULT_OK;
+	}
+
+	if (RESULT_OK != result)
+	{
+		fputs(mallocZeroException, stderr);
+		fputs("error out of memory\n", out);
+		fflush(out);
+
+		freeSaveHouses(&answer);
+
+		return result;
+	}
+
+	if (answered) printAnswer(out, &answer, currentMilliseconds() - start);
+	else
+	{
+		fprintf(out, "ok %"PRIu32" %.0f\n", watch->active ? watch->touched : 0, (currentMilliseconds() - start) * 1000.0);
+		fflush(out);
+	}
+
+	freeSaveHouses(&answer);
+
+	return RESULT_OK;
+}
+
+int serveBatch(graph_t *__restrict graph, const char *command, FILE *in, FILE *out)
+{   /* the answers come in the order of the queries, each with the time of the whole batch divided by its size. a line that is not
+	   a query gets its error line at its place, the others still get answered */
+	uint64_t count;
+	char line[QUERY_LINE_SIZE];
+
+	if (!parseNumbers(command + 6, &count, 1) || 0 == count || count > BATCH_QUERIES_MAX)
+	{
+		fputs("error expected: batch count (1 to 4096)\n", out);
+		fflush(out);
+
+		return RESULT_OK;
+	}
+
+	uint64_t (*queries)[3] = (uint64_t(*)[3])malloc(sizeof(uint64_t[3]) * count);
+	bool *valid = (bool*)malloc(sizeof(bool) * count);
+	savehouses_t *answers = (savehouses_t*)calloc(count, sizeof(savehouses_t)); /* (all empty) */
+	uint32_t read = 0;
+	int result = RESULT_OK;
+
+	if (NULL == queries || NULL == valid || NULL == answers) result = RESULT_MALLOC_ERR;
+
+	while (RESULT_OK == result && read < count && NULL != fgets(line, QUERY_LINE_SIZE, in)) /* (a client that stops early gets what it sent) */
+	{
+		if (NULL == strchr(line, '\n') && !feof(in)) /* too long, skip the rest of it */
+		{
+			int c;
+			while (EOF != (c = fgetc(in)) && '\n' != c);
+
+			valid[read++] = false;
+			continue;
+		}
+
+		valid[read] = parseNumbers(line, queries[read], 3);
+		read++;
+	}
+
+	double start = currentMilliseconds();
+
+	if (RESULT_OK == result && 0 != graph->out.addedCount && !mergeAddedEdges(graph)) result = RESULT_MALLOC_ERR; /* the searches only look at the blocks */
+
+	for (uint32_t first = 0; RESULT_OK == result && first < read;)
+	{   /* the next BATCH_LANES valid queries go together */
+		uint64_t group[BATCH_LANES][3];
+		uint32_t positions[BATCH_LANES];
+		savehouses_t results[BATCH_LANES];
+		uint32_t lanes = 0;
+
+		for (; first < read && lanes < BATCH_LANES; first++)
+		{
+			if (!valid[first]) continue;
+
+			memcpy(group[lanes], queries[first], sizeof(uint64_t[3]));
+			positions[lanes++] = first;
+		}
+
+		if (0 == lanes) break;
+
+		result = findSaveHousesBatch(graph, (const uint64_t(*)[3])group, lanes, results);
+
+		for (uint32_t i = 0; i < lanes; i++)
+		{
+			answers[positions[i]] = results[i];
+
+			if (RESULT_OK == result && !answerIsolated(graph, (uint32_t)group[i][0], (uint32_t)group[i][1], &answers[positions[i]])) result = RESULT_MALLOC_ERR;
+		}
+	}
+
+	double latency = (currentMilliseconds() - start) / (read > 0 ? read : 1);
+
+	if (RESULT_OK != result)
+	{
+		fputs(mallocZeroException, stderr);
+		fputs("error out of memory\n", out);
+		fflush(out);
+	}
+
+	for (uint32_t i = 0; RESULT_OK == result && i < read; i++)
+	{
+		if (valid[i]) printAnswer(out, &answers[i], latency);
+		else
+		{
+			fputs("error expected: start end distance\n", out);
+			fflush(out);
+		}
+	}
+
+	for (uint32_t i = 0; NULL != answers && i < read; i++) freeSaveHouses(&answers[i]);
+
+	free(queries);
+	free(valid);
+	free(answers);
+
+	return result;
+}
+
+void printAnswer(FILE *out, savehouses_t *answer, const double latency)
+{
+	fprintf(out, "%"PRIu32" %.0f", answer->count, latency * 1000.0);
+	for (uint32_t i = 0; i < answer->count; i++) fprintf(out, " %"PRIu32, answer->data[i]);
+	fputc('\n', out);
+	fflush(out);
+}
+
+int serveSocket(graph_t *__restrict graph, watch_t *__restrict watch, const char *path)
+{   /* one client after the other, each one talks the same protocol as serveQueries */
+#if POSIX_AVAILABLE
+	struct sockaddr_un address;
+
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		fputs(socketException, stderr);
+		return RESULT_INPUT_ERR;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	unlink(path); /* a socket file left over from an earlier run would block bind */
+
+	if (server < 0 || 0 != bind(server, (struct sockaddr*)&address, sizeof(address)) || 0 != listen(server, 16))
+	{
+		fputs(socketException, stderr);
+
+		if (server >= 0) close(server);
+
+		return RESULT_INPUT_ERR;
+	}
+
+	signal(SIGPIPE, SIG_IGN); /* a client that goes away should not end the server */
+
+	int result = RESULT_OK;
+	while (RESULT_OK == result)
+	{
+		int client = accept(server, NULL, NULL);
+
+		if (client < 0)
+		{
+			if (EINTR == errno) continue;
+
+			fputs(socketException, stderr);
+			result = RESULT_INPUT_ERR;
+			break;
+		}
+
+		int duplicate = dup(client); /* one FILE for reading and one for writing */
+		FILE *in = fdopen(client, "r");
+		FILE *out = (duplicate >= 0) ? fdopen(duplicate, "w") : NULL;
+
+		if (NULL != in && NULL != out) result = serveQueries(graph, watch, in, out); /* (the kept query stays for the next client) */
+
+		if (NULL != in) fclose(in);
+		else close(client);
+
+		if (NULL != out) fclose(out);
+		else if (duplicate >= 0) close(duplicate);
+	}
+
+	close(server);
+	unlink(path);
+
+	return result;
+#else
+	(void)graph;
+	(void)watch;
+	(void)path;
+
+	fputs(socketException, stderr);
+
+	return RESULT_INPUT_ERR;
+#endif
+}
+/*====SERVER ROUTINES==========================================================*/
+
+
+/*====EDGE ROUTINES============================================================*/
+bool insertEdge(edges_t *__restrict edges, const uint32_t startID, const uint32_t endID, const uint64_t distance)
+{
+	uint32_t start = mapNode(&edges->nodes, startID); /* from here on a node is its dense index */
+	uint32_t end = mapNode(&edges->nodes, endID);
+
+	if (INFINITY32 == start || INFINITY32 == end) return false;
+
+	if (edges->count == edges->limit) /* check if we reached the memory limit */
+	{
+		if (NULL != edges->spill) /* --external: the buffer keeps its size, it goes to the disk */
+		{
+			if (!spillEdges(edges)) return false;
+		}
+		else
+		{   /* realloc can grow a big block in place (or move its pages), so there is no second copy next to the old one */
+			edge_t *temp = (edge_t*)realloc(edges->data, sizeof(edge_t) * ((size_t)edges->limit << 1));
+
+			if (temp == NULL) return false; /* check if that worked */
+
+			edges->data = temp; /* set our pointer to that new array */
+			edges->limit = edges->limit << 1; /* and increase limit accordingly */
+		}
+	}
+
+	edges->data[edges->count].start = start; /* insert element at the end */
+	edges->data[edges->count].end = end;
+	edges->data[edges->count].distance = distance;
+	edges->count++; /* increase index */
+	edges->weight = mergeWeight(edges->weight, (uint32_t)distance);
+
+	return true;
+}
+
+static inline uint32_t mergeWeight(const uint32_t weight, const uint32_t distance)
+{   /* WEIGHTS_MIXED never changes again, not even for edges of weight 0 */
+	if (distance == weight) return weight;
+
+	return (INFINITY32 == weight) ? distance : WEIGHTS_MIXED;
+}
+
+bool spillEdges(edges_t *edges)
+{
+	if (edges->count != fwrite(edges->data, sizeof(edge_t), edges->count, edges->spill)) return false;
+
+	edges->spilled += edges->count;
+	edges->count = 0;
+
+	return true;
+}
+/*====EDGE ROUTINES============================================================*/
+
+
+/*====NODE MAP ROUTINES========================================================*/
+bool reserveNodes(nodeMap_t *nodes, const size_t count)
+{   /* the slots get twice as many as count (at least), the ids that are allready in there get hashed again */
+	uint32_t bits = NODE_MAP_START_BITS;
+	while (((size_t)1 << bits) < count * 2) bits++;
+
+	size_t capacity = (size_t)1 << bits;
+
+	if (capacity <= nodes->capacity) return true;
+
+	uint32_t *ids = (uint32_t*)realloc(nodes->ids, sizeof(uint32_t) * (capacity >> 1)); /* the most the slots take */
+
+	if (NULL == ids) return false;
+
+	nodes->ids = ids;
+
+	nodeSlot_t *slots = (nodeSlot_t*)malloc(sizeof(nodeSlot_t) * capacity);
+
+	if (NULL == slots) return false;
+
+	memset(slots, 0xFF, sizeof(nodeSlot_t) * capacity); /* every id is NODE_MAP_EMPTY */
+
+	for (uint32_t i = 0; i < nodes->count; i++) /* (ids has all of them in a row, no need to look through the old slots) */
+	{
+		size_t slot = hashNode(nodes->ids[i], 64 - bits);
+
+		while (NODE_MAP_EMPTY != slots[slot].id) slot = (slot + 1) & (capacity - 1);
+
+		slots[slot].id = nodes->ids[i];
+		slots[slot].index = i;
+	}
+
+	if (NULL != nodes->slots) free(nodes->slots);
+
+	nodes->slots = slots;
+	nodes->capacity = capacity;
+	nodes->shift = 64 - bits;
+
+	return true;
+}
+
+static inline size_t hashNode(const uint32_t id, const uint32_t shift)
+{   /* the group of the id is hashed, the lowest bits stay, so a run of ids is one cache line instead of one miss each */
+	size_t group = (size_t)(((uint64_t)(id >> NODE_GROUP_BITS) * NODE_HASH) >> (shift + NODE_GROUP_BITS));
+
+	return (group << NODE_GROUP_BITS) | (id & ((1 << NODE_GROUP_BITS) - 1));
+}
+
+static inline uint32_t mapNode(nodeMap_t *nodes, const uint32_t id)
+{   /* the id is in the first slot at or after its hash that is not taken by another id, or it is new */
+	if (nodes->count >= (nodes->capacity >> 1))
+	{
+		if (!reserveNodes(nodes, (size_t)nodes->count << 1)) return INFINITY32; /* double the size */
+	}
+
+	size_t mask = nodes->capacity - 1;
+	size_t slot = hashNode(id, nodes->shift);
+
+	while (1)
+	{
+		nodeSlot_t *current = &nodes->slots[slot];
+
+		if (id == current->id) return current->index;
+
+		if (NODE_MAP_EMPTY == current->id)
+		{
+			current->id = id;
+			current->index = nodes->count;
+			nodes->ids[nodes->count] = id;
+
+			return nodes->count++;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+}
+
+uint32_t lookupNode(const nodeMap_t *nodes, const uint32_t id)
+{
+	if (0 == nodes->capacity) return INFINITY32;
+
+	size_t mask = nodes->capacity - 1;
+	size_t slot = hashNode(id, nodes->shift);
+
+	while (NODE_MAP_EMPTY != nodes->slots[slot].id)
+	{
+		if (id == nodes->slots[slot].id) return nodes->slots[slot].index;
+
+		slot = (slot + 1) & mask;
+	}
+
+	return INFINITY32;
+}
+/*====NODE MAP ROUTINES========================================================*/
 
 
 /*====SAVEHOUSE ROUTINES=======================================================*/
 bool insertSaveHouse(savehouses_t *__restrict saveHouses, const uint32_t id)
 {
-	if (checkSaveHouse(saveHouses, id)) return true;
+	if (saveHouses->count == saveHouses->limit)
+	{
+		saveHouses->limit = (0 == saveHouses->limit) ? MEMORY_START_SIZE : saveHouses->limit << 1;
+
+		uint32_t *temp = (uint32_t*)realloc(saveHouses->data, sizeof(uint32_t) * saveHouses->limit); /* (data can be NULL) */
+
+		if (NULL == temp) return false;
+
+		saveHouses->data = temp;
+	}
+
+	saveHouses->data[saveHouses->count] = id;
+	saveHouses->count++;
+
+	return true;
+}
+
+void dropDuplicateSaveHouses(savehouses_t *saveHouses)
+{   /* after sorting the same ids are next to each other */
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < saveHouses->count; i++)
+	{
+		if (0 == i || saveHouses->data[i] != saveHouses->data[count - 1]) saveHouses->data[count++] = saveHouses->data[i];
+	}
+
+	saveHouses->count = count;
+}
+
+bool checkSaveHouse(savehouses_t *__restrict saveHouses, const uint32_t houseID)
+{   /* binsearch in the sorted savehouses (the nodes have their bit, this is only for ids that are not in the graph) */
+	uint32_t left = 0, right = saveHouses->count;
+
+	while (left < right)
+	{
+		uint32_t middle = left + ((right - left) >> 1);
+		if (saveHouses->data[middle] < houseID) left = middle + 1;
+		else right = middle;
+	}
+
+	return left < saveHouses->count && saveHouses->data[left] == houseID;
+}
+
+uint64_t andBitmaps(uint64_t *__restrict target, const uint64_t *__restrict a, const uint64_t *__restrict b, const size_t words)
+{   /* two words per step with sse2, the set bits get counted on the way (so the answer can be allocated once) */
+	uint64_t count = 0;
+	size_t i = 0;
+
+#if SIMD_AVAILABLE
+	for (; i + 2 <= words; i += 2)
+	{
+		__m128i bits = _mm_and_si128(_mm_loadu_si128((const __m128i*)(target + i)), _mm_loadu_si128((const __m128i*)(a + i)));
+		bits = _mm_and_si128(bits, _mm_loadu_si128((const __m128i*)(b + i)));
+		_mm_storeu_si128((__m128i*)(target + i), bits);
+
+		count += popCount64(target[i]) + popCount64(target[i + 1]);
+	}
+#endif
+
+	for (; i < words; i++)
+	{
+		target[i] &= a[i] & b[i];
+		count += popCount64(target[i]);
+	}
+
+	return count;
+}
+/*====SAVEHOUSE ROUTINES=======================================================*/
+
+
+/*====SORT ROUTINES============================================================*/
+bool radixSortSaveHouses(savehouses_t *saveHouses)
+{
+	if (!radixSort((void**)&saveHouses->data, saveHouses->count, false)) return false;
+
+	saveHouses->limit = saveHouses->count;
+
+	return true;
+}
+
+static void *radixCount(void *argument)
+{   /* first half of a pass: count how often each digit occurs in this slice */
+	radixJob_t *job = (radixJob_t*)argument;
+
+	memset(job->histogram, 0, sizeof(size_t) * RADIX_BUCKETS);
+
+	if (job->isEdges)
+	{
+		const edge_t *source = (const edge_t*)job->source;
+		for (size_t i = job->first; i < job->last; i++) job->histogram[(source[i].start >> job->shift) & (RADIX_BUCKETS - 1)]++;
+	}
+	else
+	{
+		const uint32_t *source = (const uint32_t*)job->source;
+		for (size_t i = job->first; i < job->last; i++) job->histogram[(source[i] >> job->shift) & (RADIX_BUCKETS - 1)]++;
+	}
+
+	return NULL;
+}
+
+static void *radixScatter(void *argument)
+{   /* second half: every element goes to the next free position of its digit (keeps the order, so the sort is stable) */
+	radixJob_t *job = (radixJob_t*)argument;
+
+	if (job->isEdges)
+	{
+		const edge_t *source = (const edge_t*)job->source;
+		edge_t *target = (edge_t*)job->target;
+		for (size_t i = job->first; i < job->last; i++) target[job->histogram[(source[i].start >> job->shift) & (RADIX_BUCKETS - 1)]++] = source[i];
+	}
+	else
+	{
+		const uint32_t *source = (const uint32_t*)job->source;
+		uint32_t *target = (uint32_t*)job->target;
+		for (size_t i = job->first; i < job->last; i++) target[job->histogram[(source[i] >> job->shift) & (RADIX_BUCKETS - 1)]++] = source[i];
+	}
+
+	return NULL;
+}
+
+bool radixSort(void **__restrict data, const size_t count, const bool isEdges)
+{   /* LSD radix sort on the 32 bit key, every thread takes one slice of the array */
+	if (count < 2) return true;
+
+	size_t size = isEdges ? sizeof(edge_t) : sizeof(uint32_t);
+	uint32_t threads = (count < PARALLEL_SORT_MIN) ? 1 : threadCount;
+
+	void *temp = malloc(size * count); /* the passes go back and forth between data and temp */
+	size_t *histograms = (size_t*)malloc(sizeof(size_t) * RADIX_BUCKETS * threads);
+	radixJob_t jobs[MAX_THREADS];
+
+	if (NULL == temp || NULL == histograms)
+	{
+		if (NULL != temp) free(temp);
+		if (NULL != histograms) free(histograms);
+
+		return false;
+	}
+
+	void *source = *data, *target = temp;
+
+	for (uint32_t pass = 0; pass < RADIX_PASSES; pass++)
+	{
+		for (uint32_t t = 0; t < threads; t++)
+		{
+			jobs[t].source = source;
+			jobs[t].target = target;
+			jobs[t].isEdges = isEdges;
+			jobs[t].first = count * t / threads;
+			jobs[t].last = count * (t + 1) / threads;
+			jobs[t].shift = pass * RADIX_BITS;
+			jobs[t].histogram = histograms + (size_t)t * RADIX_BUCKETS;
+		}
+
+		runParallel(radixCount, jobs, sizeof(radixJob_t), threads);
+
+		/* turn the counts into write positions: digit by digit, and within a digit slice by slice */
+		size_t position = 0;
+		bool skip = false;
+		for (uint32_t bucket = 0; bucket < RADIX_BUCKETS; bucket++)
+		{
+			size_t start = position;
+			for (uint32_t t = 0; t < threads; t++)
+			{
+				size_t amount = jobs[t].histogram[bucket];
+				jobs[t].histogram[bucket] = position;
+				position += amount;
+			}
+
+			if (position - start == count) skip = true; /* every element has the same digit, so this pass would not change anything */
+		}
+
+		if (skip) continue;
+
+		runParallel(radixScatter, jobs, sizeof(radixJob_t), threads);
+
+		void *swap = source; /* the result of this pass is the input of the next one */
+		source = target;
+		target = swap;
+	}
+
+	free(histograms);
+
+	if (source != *data) /* the sorted data ended up in temp, so just keep that buffer */
+	{
+		free(*data);
+		*data = source;
+	}
+	else free(temp);
+
+	return true;
+}
+/*====SORT ROUTINES============================================================*/
+
+
+/*====THREAD ROUTINES==========================================================*/
+void runParallel(worker_t worker, void *__restrict jobs, const size_t jobSize, const uint32_t count)
+{   /* the first job runs on the calling thread, so count == 1 does not start any thread at all */
+#if POSIX_AVAILABLE
+	pthread_t threads[MAX_THREADS];
+	bool started[MAX_THREADS];
+
+	for (uint32_t i = 1; i < count; i++)
+	{   /* if a thread can not be started its job just runs here afterwards */
+		started[i] = (0 == pthread_create(&threads[i], NULL, worker, (char*)jobs + jobSize * i));
+	}
+
+	worker(jobs);
+
+	for (uint32_t i = 1; i < count; i++)
+	{
+		if (started[i]) pthread_join(threads[i], NULL);
+		else worker((char*)jobs + jobSize * i);
+	}
+#else
+	for (uint32_t i = 0; i < count; i++) worker((char*)jobs + jobSize * i);
+#endif
+}
+/*====THREAD ROUTINES==========================================================*/
+
+
+/*====GRAPH ROUTINES===========================================================*/
+bool buildGraph(savehouses_t *__restrict saveHouses, edges_t *__restrict edges, graph_t *__restrict graph)
+{   /* the edges come with dense indices (see nodeMap_t), the savehouses have to be sorted, then every pass here is linear */
+	graph->count = 0;
+	graph->ids = NULL;
+	graph->saveHouseBits = NULL;
+	graph->out.offsets = graph->in.offsets = NULL;
+	graph->out.neighbours = graph->in.neighbours = NULL;
+	graph->out.count = graph->in.count = 0;
+	graph->out.addedHeads = graph->in.addedHeads = NULL;
+	graph->out.added = graph->in.added = NULL;
+	graph->out.addedCount = graph->in.addedCount = 0;
+	graph->out.addedLimit = graph->in.addedLimit = 0;
+	memset(&graph->hierarchy, 0, sizeof(hierarchy_t));
+	graph->hopWeight = (INFINITY32 == edges->weight) ? WEIGHTS_MIXED : edges->weight; /* (without edges there are no hops either) */
+	graph->snapshot = NULL;
+	graph->snapshotSize = 0;
+
+	graph->saveHouses = *saveHouses; /* the graph owns the savehouses from now on (for nodes without edges) */
+	saveHouses->data = NULL;
+	saveHouses->count = saveHouses->limit = 0;
+
+	/* the start and end node are nodes even if they have no edges */
+	if (INFINITY32 == mapNode(&edges->nodes, globalStartID) || INFINITY32 == mapNode(&edges->nodes, globalEndID)) return false;
+
+	/* the nodes get renumbered in the order of their ids, so the savehouses can be matched in one pass, the answer comes out
+	   sorted and findNode (and a snapshot) can do a binsearch in the ids. only the different ids get sorted, not the edges */
+	uint32_t count = edges->nodes.count;
+	uint32_t *ids = (uint32_t*)malloc(sizeof(uint32_t) * count);
+
+	if (NULL == ids) return false;
+
+	memcpy(ids, edges->nodes.ids, sizeof(uint32_t) * count);
+
+	if (!radixSort((void**)&ids, count, false))
+	{
+		free(ids);
+		return false;
+	}
+
+	graph->ids = ids;
+	graph->count = count;
+
+	uint32_t *order = (uint32_t*)malloc(sizeof(uint32_t) * count); /* the new index of every dense index */
+	uint32_t *positions = (uint32_t*)malloc(sizeof(uint32_t) * count); /* next free place in each block */
+
+	bool external = (NULL != edges->spill); /* --external: the neighbours get no block in memory */
+
+	graph->saveHouseBits = (uint64_t*)calloc(((size_t)count + 63) >> 6, sizeof(uint64_t));
+	graph->out.offsets = (uint32_t*)calloc(count + 1, sizeof(uint32_t));
+	graph->in.offsets = (uint32_t*)calloc(count + 1, sizeof(uint32_t));
+
+	if (!external)
+	{
+		graph->out.neighbours = (neighbour_t*)malloc(sizeof(neighbour_t) * (edges->count > 0 ? edges->count : 1));
+		graph->in.neighbours = (neighbour_t*)malloc(sizeof(neighbour_t) * (edges->count > 0 ? edges->count : 1));
+	}
+
+	if (NULL == order || NULL == positions || NULL == graph->saveHouseBits || NULL == graph->out.offsets || NULL == graph->in.offsets ||
+		(!external && (NULL == graph->out.neighbours || NULL == graph->in.neighbours)))
+	{
+		if (NULL != order) free(order);
+		if (NULL != positions) free(positions);
+
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; i++) order[lookupNode(&edges->nodes, graph->ids[i])] = i;
+
+	/* the savehouses are sorted as well, so they can be matched while going through the nodes once */
+	uint32_t house = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		while (house < graph->saveHouses.count && graph->saveHouses.data[house] < graph->ids[i]) house++;
+
+		if (house < graph->saveHouses.count && graph->saveHouses.data[house] == graph->ids[i]) SET_BIT(graph->saveHouseBits, i);
+	}
+
+	if (external) /* the counting sort below needs all edges in memory, these get sorted on disk */
+	{
+		bool built = buildExternalAdjacency(edges, graph, order);
+
+		free(order);
+		free(positions);
+
+		return built;
+	}
+
+	/* outgoing edges: counting sort by the start node. --compress packs the gaps between the neighbours, so then (and for a
+	   snapshot, it can be compressed later) the edges first go by their end node into the incoming blocks, LSD-style, and the
+	   stable sort from there leaves every node with its neighbours in order */
+	bool sortRows = compressMode || NULL != exportPath;
+	adjacency_t *first = sortRows ? &graph->in : &graph->out;
+
+	for (uint32_t i = 0; i < edges->count; i++)
+	{
+		graph->out.offsets[order[edges->data[i].start] + 1]++;
+		graph->in.offsets[order[edges->data[i].end] + 1]++; /* count the incoming edges on the way */
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		graph->out.offsets[i + 1] += graph->out.offsets[i];
+		graph->in.offsets[i + 1] += graph->in.offsets[i];
+	}
+
+	memcpy(positions, first->offsets, sizeof(uint32_t) * count);
+
+	for (uint32_t i = 0; i < edges->count; i++)
+	{
+		uint32_t start = order[edges->data[i].start], end = order[edges->data[i].end];
+		neighbour_t *target = &first->neighbours[positions[sortRows ? end : start]++];
+		target->index = sortRows ? start : end;
+		target->distance = (uint32_t)edges->data[i].distance;
+	}
+
+	free(order);
+
+	if (sortRows)
+	{
+		memcpy(positions, graph->out.offsets, sizeof(uint32_t) * count);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			for (uint32_t j = graph->in.offsets[i]; j < graph->in.offsets[i + 1]; j++)
+			{
+				neighbour_t *target = &graph->out.neighbours[positions[graph->in.neighbours[j].index]++];
+				target->index = i;
+				target->distance = graph->in.neighbours[j].distance;
+			}
+		}
+	}
+
+	graph->out.count = edges->count;
+
+	/* incoming edges: transpose the outgoing ones (counting sort by the end node, the starts come out sorted) */
+	memcpy(positions, graph->in.offsets, sizeof(uint32_t) * count);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		for (uint32_t j = graph->out.offsets[i]; j < graph->out.offsets[i + 1]; j++)
+		{
+			neighbour_t *target = &graph->in.neighbours[positions[graph->out.neighbours[j].index]++];
+			target->index = i;
+			target->distance = graph->out.neighbours[j].distance;
+		}
+	}
+
+	free(positions);
+
+	graph->in.count = graph->out.count;
+
+	return true;
+}
+
+uint32_t findNode(graph_t *__restrict graph, const uint32_t id)
+{   /* binsearch in the sorted ids (4 bytes each, so a lot of them fit into the cache) */
+	uint32_t left = 0, right = graph->count;
+
+	if (statsMode) stats.findNodeCalls++; /* (only the main thread looks up ids) */
+
+	while (left < right)
+	{
+		uint32_t middle = left + ((right - left) >> 1);
+		if (graph->ids[middle] < id) left = middle + 1;
+		else right = middle;
+	}
+
+	if (left < graph->count && graph->ids[left] == id) return left;
+
+	return INFINITY32;
+}
+
+bool hasEdgeWithin(adjacency_t *__restrict adjacency, const uint32_t first, const uint32_t last, const uint64_t limit)
+{   /* checks neighbours[first] to neighbours[last - 1], stops at the first one that is close enough */
+	if (NULL != adjacency->pager) return last > first; /* --external only keeps the edges within the limit (it answers one query) */
+
+	for (uint32_t i = first; i < last; i++) if (adjacency->neighbours[i].distance <= limit) return true;
+
+	return false;
+}
+/*====GRAPH ROUTINES===========================================================*/
+
+
+/*====COMPRESSION ROUTINES=====================================================*/
+bool compressGraph(graph_t *graph)
+{   /* the blocks are only dropped if both directions could be packed (mapped ones just stop being used) */
+	if (!compressAdjacency(&graph->out, graph->count) || !compressAdjacency(&graph->in, graph->count))
+	{
+		freePacked(&graph->out);
+		freePacked(&graph->in);
+
+		return false;
+	}
+
+	if (NULL == graph->snapshot)
+	{
+		free(graph->out.offsets);
+		free(graph->out.neighbours);
+		free(graph->in.offsets);
+		free(graph->in.neighbours);
+	}
+
+	graph->out.offsets = graph->in.offsets = NULL;
+	graph->out.neighbours = graph->in.neighbours = NULL;
+
+	return true;
+}
+
+bool compressAdjacency(adjacency_t *adjacency, const uint32_t count)
+{   /* sorted neighbours (buildGraph puts them in order) are close to each other (and often to the node), so most gaps fit into
+	   one byte. the weights all get the width of the longest one, after the indices of the node and starting at a byte */
+	uint32_t longest = 0, maxDegree = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t degree = adjacency->offsets[i + 1] - adjacency->offsets[i];
+		maxDegree = (degree > maxDegree) ? degree : maxDegree;
+	}
+
+	for (uint32_t i = 0; i < adjacency->count; i++)
+	{
+		uint32_t distance = adjacency->neighbours[i].distance;
+		if (EDGE_REMOVED != distance && distance > longest) longest = distance;
+	}
+
+	createGapShuffles();
+
+	adjacency->weightBits = bitLength(longest);
+	adjacency->maxDegree = maxDegree;
+	adjacency->bases = (uint64_t*)malloc(sizeof(uint64_t) * (((size_t)count >> PACKED_BLOCK_BITS) + 1));
+	adjacency->positions = (uint32_t*)malloc(sizeof(uint32_t) * (count > 0 ? count : 1));
+	adjacency->packed = NULL;
+	adjacency->packedSize = 0;
+
+	size_t limit = 0;
+	neighbour_t *sorted = (neighbour_t*)malloc(sizeof(neighbour_t) * (maxDegree > 0 ? maxDegree : 1));
+	bool success = (NULL != adjacency->bases && NULL != adjacency->positions && NULL != sorted);
+
+	for (uint32_t i = 0; i < count && success; i++)
+	{
+		uint32_t degree = 0;
+
+		for (uint32_t j = adjacency->offsets[i]; j < adjacency->offsets[i + 1]; j++) /* (a removed edge is not needed anymore) */
+		{
+			if (EDGE_REMOVED != adjacency->neighbours[j].distance) sorted[degree++] = adjacency->neighbours[j];
+		}
+
+		if (0 == (i & ((1 << PACKED_BLOCK_BITS) - 1))) adjacency->bases[i >> PACKED_BLOCK_BITS] = adjacency->packedSize;
+
+		uint64_t position = adjacency->packedSize - adjacency->bases[i >> PACKED_BLOCK_BITS];
+
+		/* (at most 5 bytes per varint, 4 per gap plus a control byte per 4 of them and 4 per weight) */
+		if (position > UINT32_MAX || !appendPacked(adjacency, &limit, 11 + (size_t)degree * 9))
+		{
+			success = false;
+			break;
+		}
+
+		adjacency->positions[i] = (uint32_t)position;
+
+		uint8_t *target = writeVarint(&adjacency->packed[adjacency->packedSize], degree);
+
+		if (degree > 0)
+		{
+			int64_t delta = (int64_t)sorted[0].index - (int64_t)i;
+			target = writeVarint(target, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63)); /* zigzag: small either way */
+			target = writeGaps(target, sorted, degree);
+		}
+
+		uint64_t bits = 0; /* the weights go in from the lowest bit of every byte up */
+		uint32_t used = 0;
+
+		for (uint32_t j = 0; j < degree; j++)
+		{
+			bits |= (uint64_t)sorted[j].distance << used;
+			used += adjacency->weightBits;
+
+			for (; used >= 8; used -= 8, bits >>= 8) *target++ = (uint8_t)bits;
+		}
+
+		if (used > 0) *target++ = (uint8_t)bits;
+
+		adjacency->packedSize = (size_t)(target - adjacency->packed);
+	}
+
+	free(sorted);
+
+	if (!success) return false;
+
+	/* only as much as is used, plus the padding the weights are read with */
+	if (!appendPacked(adjacency, &limit, 0)) return false;
+
+	uint8_t *temp = (uint8_t*)realloc(adjacency->packed, adjacency->packedSize + PACKED_PADDING);
+	if (NULL != temp) adjacency->packed = temp;
+
+	memset(&adjacency->packed[adjacency->packedSize], 0, PACKED_PADDING);
+
+	return true;
+}
+
+bool appendPacked(adjacency_t *__restrict adjacency, size_t *__restrict limit, const size_t size)
+{   /* limit is how many bytes packed has room for, it grows by half (plus the padding that comes at the end) */
+	if (adjacency->packedSize + size + PACKED_PADDING <= *limit) return true;
+
+	size_t newLimit = *limit + (*limit >> 1) + size + PACKED_PADDING + MEMORY_START_SIZE;
+	uint8_t *temp = (uint8_t*)realloc(adjacency->packed, newLimit);
+
+	if (NULL == temp) return false;
+
+	adjacency->packed = temp;
+	*limit = newLimit;
+
+	return true;
+}
+
+static inline uint32_t unpackNeighbours(const adjacency_t *__restrict adjacency, const uint32_t index, neighbour_t *__restrict target)
+{   /* the opposite of compressAdjacency, target needs room for maxDegree + 3 neighbours (readGaps writes 4 at a time) */
+	const uint8_t *data = &adjacency->packed[adjacency->bases[index >> PACKED_BLOCK_BITS] + adjacency->positions[index]];
+	uint32_t count = (uint32_t)readVarint(&data);
+
+	if (0 == count) return 0;
+
+	uint64_t first = readVarint(&data);
+	uint32_t neighbour = index + (uint32_t)((first >> 1) ^ (0 - (first & 1))); /* (wraps around like the delta did) */
+
+	target[0].index = neighbour;
+	data = readGaps(data, count - 1, neighbour, &target[1]);
+
+	const uint32_t bits = adjacency->weightBits;
+	const uint32_t mask = (uint32_t)(((uint64_t)1 << bits) - 1);
+
+	for (uint32_t i = 0, position = 0; i < count; i++, position += bits) /* (at most 7 + 32 bits, one load is enough) */
+	{
+		target[i].distance = (uint32_t)(loadLittle64(&data[position >> 3]) >> (position & 7)) & mask;
+	}
+
+	return count;
+}
+
+static inline uint8_t *writeGaps(uint8_t *__restrict target, const neighbour_t *__restrict sorted, const uint32_t count)
+{   /* stream vbyte: a control byte for every 4 gaps (2 bits each, how many bytes - 1), then the gaps in as few bytes as they
+	   need. unlike a varint the length of a gap does not depend on the gap before, so 4 of them can be decoded at once */
+	uint32_t gaps = count - 1;
+	uint8_t *control = target;
+
+	memset(control, 0, (gaps + 3) / 4);
+	target += (gaps + 3) / 4;
+
+	for (uint32_t j = 0; j < gaps; j++)
+	{
+		uint32_t gap = sorted[j + 1].index - sorted[j].index;
+		uint32_t bytes = (gap < (1 << 8)) ? 1 : (gap < (1 << 16)) ? 2 : (gap < (1 << 24)) ? 3 : 4;
+
+		control[j >> 2] |= (uint8_t)((bytes - 1) << ((j & 3) * 2));
+
+		for (uint32_t k = 0; k < bytes; k++) *target++ = (uint8_t)(gap >> (k * 8));
+	}
+
+	return target;
+}
+
+static inline const uint8_t *readGaps(const uint8_t *__restrict control, const uint32_t gaps, uint32_t neighbour, neighbour_t *__restrict target)
+{   /* the opposite of writeGaps, gives where the weights start */
+	const uint8_t *data = control + (gaps + 3) / 4;
+	uint32_t j = 0;
+
+#if SSSE3_AVAILABLE
+	const __m128i zero = _mm_setzero_si128();
+	__m128i last = _mm_set1_epi32((int)neighbour);
+
+	for (; j < gaps; j += 4) /* the bytes of 4 gaps go to their lanes, then the sums of them go next to a zero weight */
+	{
+		uint32_t bits = control[j >> 2];
+		__m128i values = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), _mm_loadu_si128((const __m128i*)gapShuffles[bits]));
+
+		values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+		values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+		values = _mm_add_epi32(values, last);
+		last = _mm_shuffle_epi32(values, 0xFF);
+
+		_mm_storeu_si128((__m128i*)&target[j], _mm_unpacklo_epi32(values, zero));
+		_mm_storeu_si128((__m128i*)&target[j + 2], _mm_unpackhi_epi32(values, zero));
+		data += gapBytes[bits];
+	}
+
+	data -= (0 - gaps) & 3; /* the lanes after the last gap were counted with one byte each (and written to target after count) */
+#endif
+
+	for (; j < gaps; j++) /* (the padding is there for the 8 byte load) */
+	{
+		uint32_t bytes = ((control[j >> 2] >> ((j & 3) * 2)) & 3) + 1;
+
+		neighbour += (uint32_t)loadLittle64(data) & (UINT32_MAX >> (32 - bytes * 8));
+		target[j].index = neighbour;
+		data += bytes;
+	}
+
+	return data;
+}
+
+void createGapShuffles(void)
+{   /* (the same every time, compressAdjacency makes them before the first search) */
+#if SSSE3_AVAILABLE
+	for (uint32_t bits = 0; bits < 256; bits++)
+	{
+		uint32_t position = 0;
+
+		for (uint32_t lane = 0; lane < 4; lane++)
+		{
+			uint32_t bytes = ((bits >> (lane * 2)) & 3) + 1;
+
+			for (uint32_t k = 0; k < 4; k++) gapShuffles[bits][lane * 4 + k] = (k < bytes) ? (uint8_t)(position + k) : 0x80;
+
+			position += bytes;
+		}
+
+		gapBytes[bits] = (uint8_t)position;
+	}
+#endif
+}
+
+static inline uint8_t *writeVarint(uint8_t *target, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		*target++ = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+
+	*target++ = (uint8_t)value;
+
+	return target;
+}
+
+static inline uint64_t readVarint(const uint8_t **data)
+{
+	const uint8_t *current = *data;
+	uint64_t value = *current & 0x7F;
+
+	for (uint32_t shift = 7; *current++ & 0x80; shift += 7) value |= (uint64_t)(*current & 0x7F) << shift;
+
+	*data = current;
+
+	return value;
+}
+
+static inline uint64_t loadLittle64(const uint8_t *data)
+{   /* (compilers turn this into one load on little endian machines) */
+	return (uint64_t)data[0] | ((uint64_t)data[1] << 8) | ((uint64_t)data[2] << 16) | ((uint64_t)data[3] << 24) |
+		((uint64_t)data[4] << 32) | ((uint64_t)data[5] << 40) | ((uint64_t)data[6] << 48) | ((uint64_t)data[7] << 56);
+}
+
+void freePacked(adjacency_t *adjacency)
+{
+	if (NULL != adjacency->bases) free(adjacency->bases);
+	if (NULL != adjacency->positions) free(adjacency->positions);
+	if (NULL != adjacency->packed) free(adjacency->packed);
+
+	adjacency->bases = NULL;
+	adjacency->positions = NULL;
+	adjacency->packed = NULL;
+	adjacency->packedSize = 0;
+}
+/*====COMPRESSION ROUTINES=====================================================*/
+
+
+/*====EXTERNAL ROUTINES========================================================*/
+FILE *openScratch(void)
+{   /* the name is removed right away, so nothing is left behind whatever happens (the file stays until it is closed) */
+#if POSIX_AVAILABLE
+	size_t length = strlen(externalPath);
+	char *path = (char*)malloc(length + sizeof("/loesung-XXXXXX"));
+
+	if (NULL == path) return NULL;
+
+	memcpy(path, externalPath, length);
+	memcpy(path + length, "/loesung-XXXXXX", sizeof("/loesung-XXXXXX"));
+
+	FILE *file = NULL;
+	int descriptor = mkstemp(path);
+
+	if (descriptor >= 0)
+	{
+		unlink(path);
+		file = fdopen(descriptor, "w+b");
+
+		if (NULL == file) close(descriptor);
+	}
+
+	free(path);
+
+	return file;
+#else
+	return tmpfile(); /* (without mkstemp the file is in the temp directory of the system) */
+#endif
+}
+
+bool readScratch(FILE *file, void *target, const size_t size, const uint64_t offset)
+{   /* pread does not move the position of the file, written data has to be flushed before */
+#if POSIX_AVAILABLE
+	for (size_t done = 0; done < size;)
+	{
+		ssize_t amount = pread(fileno(file), (char*)target + done, size - done, (off_t)(offset + done));
+
+		if (amount < 0 && EINTR == errno) continue;
+		if (amount <= 0) return false;
+
+		done += (size_t)amount;
+	}
+
+	return true;
+#elif defined(_MSC_VER)
+	return 0 == _fseeki64(file, (__int64)offset, SEEK_SET) && size == fread(target, 1, size, file);
+#else
+	return 0 == fseek(file, (long)offset, SEEK_SET) && size == fread(target, 1, size, file);
+#endif
+}
+
+bool buildExternalAdjacency(edges_t *__restrict edges, graph_t *__restrict graph, const uint32_t *__restrict order)
+{   /* the spill file is read one buffer at a time, every buffer is sorted by start (a run of the outgoing edges) and with start
+	   and end swapped by end (one of the incoming edges). the runs of each direction are merged into a file that is exactly
+	   what the block would be. only the offsets stay in memory, both files are read and written from start to end */
+	uint64_t chunk = edges->limit; /* (the sorts change limit) */
+
+	if (!spillEdges(edges) || 0 != fflush(edges->spill) || edges->spilled > UINT32_MAX) return false;
+
+	uint32_t total = (uint32_t)edges->spilled;
+	graph->out.count = graph->in.count = total;
+
+	if (0 == total) /* there is nothing to page, empty blocks do the same */
+	{
+		graph->out.neighbours = (neighbour_t*)malloc(sizeof(neighbour_t));
+		graph->in.neighbours = (neighbour_t*)malloc(sizeof(neighbour_t));
+
+		return NULL != graph->out.neighbours && NULL != graph->in.neighbours;
+	}
+
+	uint64_t runCount = (total + chunk - 1) / chunk;
+	FILE *runs[2] = { openScratch(), openScratch() }; /* the runs of out and in, one after the other */
+	bool success = NULL != runs[0] && NULL != runs[1];
+
+	rewind(edges->spill);
+
+	for (uint64_t run = 0; success && run < runCount; run++)
+	{
+		size_t count = (size_t)((total - run * chunk < chunk) ? total - run * chunk : chunk);
+
+		if (count != fread(edges->data, sizeof(edge_t), count, edges->spill))
+		{
+			success = false;
+			break;
+		}
+
+		edge_t *data = edges->data;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			data[i].start = order[data[i].start]; /* the index of the sorted id, like the blocks */
+			data[i].end = order[data[i].end];
+			graph->out.offsets[data[i].start + 1]++;
+			graph->in.offsets[data[i].end + 1]++;
+		}
+
+		success = radixSort((void**)&edges->data, count, true) && count == fwrite(edges->data, sizeof(edge_t), count, runs[0]);
+
+		data = edges->data; /* (the sort might have swapped the buffer) */
+
+		for (size_t i = 0; success && i < count; i++)
+		{
+			uint32_t swap = data[i].start;
+			data[i].start = data[i].end;
+			data[i].end = swap;
+		}
+
+		success = success && radixSort((void**)&edges->data, count, true) && count == fwrite(edges->data, sizeof(edge_t), count, runs[1]);
+	}
+
+	fclose(edges->spill); /* everything is in the runs now */
+	edges->spill = NULL;
+
+	for (uint32_t i = 0; i < graph->count; i++)
+	{
+		graph->out.offsets[i + 1] += graph->out.offsets[i];
+		graph->in.offsets[i + 1] += graph->in.offsets[i];
+	}
+
+	/* the merge splits one buffer between the runs (more than the budget if there are so many runs that the parts get too short) */
+	uint64_t share = chunk / runCount;
+	if (share < EXTERNAL_RUN_BUFFER_MIN) share = EXTERNAL_RUN_BUFFER_MIN;
+
+	if (success)
+	{
+		edge_t *temp = (edge_t*)realloc(edges->data, sizeof(edge_t) * share * runCount);
+
+		if (NULL == temp) success = false;
+		else
+		{
+			edges->data = temp;
+			edges->limit = (uint32_t)(share * runCount);
+			edges->count = 0;
+		}
+	}
+
+	adjacency_t *directions[2] = { &graph->out, &graph->in };
+
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		FILE *file = success ? openScratch() : NULL;
+
+		success = NULL != file && mergeRuns(runs[i], file, edges->data, share, chunk, total) && createPager(directions[i], file, memoryBudget / 2);
+
+		if (!success && NULL != file) fclose(file);
+
+		if (NULL != runs[i]) fclose(runs[i]); /* (the pager has the merged file) */
+		runs[i] = NULL;
+	}
+
+	return success;
+}
+
+bool mergeRuns(FILE *__restrict runs, FILE *__restrict target, edge_t *__restrict buffer, const uint64_t share, const uint64_t chunk, const uint64_t total)
+{   /* k-way merge, the heap has the run with the smallest next start on top (that start is its key, like a distance). only the
+	   end and the weight of each edge are written, so the file has the neighbours of node 0, then those of node 1 and so on */
+	uint32_t runCount = (uint32_t)((total + chunk - 1) / chunk);
+	mergeRun_t *state = (mergeRun_t*)malloc(sizeof(mergeRun_t) * runCount);
+	uint32_t *starts = (uint32_t*)malloc(sizeof(uint32_t) * runCount);
+	neighbour_t *output = (neighbour_t*)malloc(sizeof(neighbour_t) * EXTERNAL_PAGE_NEIGHBOURS);
+	heap_t heap;
+	vertices_t keys;
+
+	heap.count = 0;
+	heap.limit = MEMORY_START_SIZE;
+	heap.data = (uint32_t*)malloc(sizeof(uint32_t) * MEMORY_START_SIZE);
+	heap.positions = (uint32_t*)malloc(sizeof(uint32_t) * runCount);
+	keys.distances = starts;
+	keys.visited = NULL;
+
+	bool success = NULL != state && NULL != starts && NULL != output && NULL != heap.data && NULL != heap.positions && 0 == fflush(runs);
+
+	if (success) memset(heap.positions, 0xFF, sizeof(uint32_t) * runCount); /* nothing is in the heap */
+
+	for (uint32_t i = 0; success && i < runCount; i++)
+	{
+		state[i].offset = i * chunk;
+		state[i].end = (total - i * chunk < chunk) ? total : (i + 1) * chunk;
+		state[i].buffer = buffer + i * share;
+
+		success = refillRun(runs, &state[i], share);
+
+		if (success)
+		{
+			starts[i] = state[i].buffer[0].start;
+			success = insertNodeToHeap(&keys, &heap, i);
+		}
+	}
+
+	uint32_t outputCount = 0;
+
+	while (success)
+	{
+		uint32_t i = removeMinNodeFromHeap(&keys, &heap);
+
+		if (INFINITY32 == i) break; /* every run is done */
+
+		mergeRun_t *run = &state[i];
+		edge_t *edge = &run->buffer[run->position++];
+
+		output[outputCount].index = edge->end;
+		output[outputCount].distance = (uint32_t)edge->distance;
+
+		if (++outputCount == EXTERNAL_PAGE_NEIGHBOURS)
+		{
+			success = EXTERNAL_PAGE_NEIGHBOURS == fwrite(output, sizeof(neighbour_t), EXTERNAL_PAGE_NEIGHBOURS, target);
+			outputCount = 0;
+		}
+
+		if (run->position == run->count && run->offset < run->end) success = success && refillRun(runs, run, share);
+
+		if (success && run->position < run->count) /* back into the heap with its next start */
+		{
+			starts[i] = run->buffer[run->position].start;
+			success = insertNodeToHeap(&keys, &heap, i);
+		}
+	}
+
+	success = success && outputCount == fwrite(output, sizeof(neighbour_t), outputCount, target) && 0 == fflush(target);
+
+	if (NULL != state) free(state);
+	if (NULL != starts) free(starts);
+	if (NULL != output) free(output);
+	if (NULL != heap.data) free(heap.data);
+	if (NULL != heap.positions) free(heap.positions);
+
+	return success;
+}
+
+bool refillRun(FILE *__restrict runs, mergeRun_t *__restrict run, const uint64_t share)
+{
+	uint64_t count = (run->end - run->offset < share) ? run->end - run->offset : share;
+
+	if (!readScratch(runs, run->buffer, sizeof(edge_t) * count, sizeof(edge_t) * run->offset)) return false;
+
+	run->offset += count;
+	run->position = 0;
+	run->count = (uint32_t)count;
+
+	return true;
+}
+
+bool createPager(adjacency_t *__restrict adjacency, FILE *__restrict file, const uint64_t bytes)
+{   /* the frames get as many pages as fit into bytes, the pager owns the file afterwards (not if this fails) */
+	uint32_t pageCount = (uint32_t)(((uint64_t)adjacency->count + EXTERNAL_PAGE_NEIGHBOURS - 1) / EXTERNAL_PAGE_NEIGHBOURS);
+	uint64_t frameCount = bytes / (sizeof(neighbour_t) * EXTERNAL_PAGE_NEIGHBOURS);
+
+	if (frameCount > pageCount) frameCount = pageCount;
+	if (0 == frameCount) frameCount = 1;
+
+	pager_t *pager = (pager_t*)calloc(1, sizeof(pager_t));
+
+	if (NULL == pager) return false;
+
+	pager->file = file;
+	pager->count = adjacency->count;
+	pager->frameCount = (uint32_t)frameCount;
+	pager->frameOf = (uint32_t*)malloc(sizeof(uint32_t) * (pageCount > 0 ? pageCount : 1));
+	pager->pageOf = (uint32_t*)malloc(sizeof(uint32_t) * frameCount);
+	pager->referenced = (uint64_t*)calloc(BITMAP_WORDS(frameCount), sizeof(uint64_t));
+	pager->frames = (neighbour_t*)malloc(sizeof(neighbour_t) * EXTERNAL_PAGE_NEIGHBOURS * frameCount);
+
+	if (NULL == pager->frameOf || NULL == pager->pageOf || NULL == pager->referenced || NULL == pager->frames)
+	{
+		pager->file = NULL; /* (the caller closes it) */
+		adjacency->pager = pager;
+		freePager(adjacency);
+
+		return false;
+	}
+
+	memset(pager->frameOf, 0xFF, sizeof(uint32_t) * pageCount); /* nothing is in memory yet */
+	memset(pager->pageOf, 0xFF, sizeof(uint32_t) * frameCount);
+
+	adjacency->pager = pager;
+
+	return true;
+}
+
+static inline const neighbour_t *pageNeighbours(pager_t *__restrict pager, const uint32_t position, uint32_t *__restrict count)
+{   /* the neighbours from position on as far as they are in the same page (count gets cut to those), NULL if it can not be read */
+	uint32_t page = position / EXTERNAL_PAGE_NEIGHBOURS;
+	uint32_t first = position % EXTERNAL_PAGE_NEIGHBOURS;
+	uint32_t frame = pager->frameOf[page];
+
+	if (*count > EXTERNAL_PAGE_NEIGHBOURS - first) *count = EXTERNAL_PAGE_NEIGHBOURS - first;
+
+	pager->requests++;
+
+	if (INFINITY32 == frame && INFINITY32 == (frame = loadPage(pager, page))) return NULL;
+
+	SET_BIT(pager->referenced, frame);
+
+	return &pager->frames[(size_t)frame * EXTERNAL_PAGE_NEIGHBOURS + first];
+}
+
+uint32_t loadPage(pager_t *pager, const uint32_t page)
+{   /* CLOCK: the hand passes the frames that were used since it came by the last time (and clears their bit), the first
+	   other one gets the page. the block that is looked at is never replaced, a search asks for one page at a time */
+	while (TEST_BIT(pager->referenced, pager->hand))
+	{
+		CLEAR_BIT(pager->referenced, pager->hand);
+		pager->hand = (pager->hand + 1 == pager->frameCount) ? 0 : pager->hand + 1;
+	}
+
+	uint32_t frame = pager->hand;
+	pager->hand = (frame + 1 == pager->frameCount) ? 0 : frame + 1;
+
+	if (INFINITY32 != pager->pageOf[frame]) pager->frameOf[pager->pageOf[frame]] = INFINITY32; /* the page that was there is gone */
+
+	pager->pageOf[frame] = INFINITY32;
+
+	uint64_t first = (uint64_t)page * EXTERNAL_PAGE_NEIGHBOURS;
+	uint64_t count = (pager->count - first < EXTERNAL_PAGE_NEIGHBOURS) ? pager->count - first : EXTERNAL_PAGE_NEIGHBOURS;
+
+	if (!readScratch(pager->file, &pager->frames[(size_t)frame * EXTERNAL_PAGE_NEIGHBOURS], sizeof(neighbour_t) * count, sizeof(neighbour_t) * first))
+	{
+		return INFINITY32;
+	}
+
+	pager->pageOf[frame] = page;
+	pager->frameOf[page] = frame;
+	pager->reads++;
+
+	return frame;
+}
+
+void freePager(adjacency_t *adjacency)
+{
+	pager_t *pager = adjacency->pager;
+
+	if (NULL == pager) return;
+
+	if (NULL != pager->file) fclose(pager->file); /* (that deletes it) */
+	if (NULL != pager->frameOf) free(pager->frameOf);
+	if (NULL != pager->pageOf) free(pager->pageOf);
+	if (NULL != pager->referenced) free(pager->referenced);
+	if (NULL != pager->frames) free(pager->frames);
+
+	free(pager);
+	adjacency->pager = NULL;
+}
+/*====EXTERNAL ROUTINES========================================================*/
+
+
+/*====SNAPSHOT ROUTINES========================================================*/
+void fillSnapshotHeader(graph_t *__restrict graph, snapshotHeader_t *__restrict header)
+{
+	memset(header, 0, sizeof(snapshotHeader_t));
+	memcpy(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic));
+	header->version = SNAPSHOT_VERSION;
+	header->byteOrder = SNAPSHOT_BYTE_ORDER;
+	header->nodeCount = graph->count;
+	header->edgeCount = graph->out.count;
+	header->saveHouseCount = graph->saveHouses.count;
+	header->startID = globalStartID;
+	header->endID = globalEndID;
+	header->distance = globalDistance;
+
+	if (NULL != graph->hierarchy.order)
+	{
+		header->hierarchy = 1;
+		header->upCount = graph->hierarchy.up.count;
+		header->downCount = graph->hierarchy.down.count;
+	}
+}
+
+void snapshotSectionSizes(const snapshotHeader_t *__restrict header, uint64_t *__restrict sizes)
+{
+	uint64_t levels = (0 != header->hierarchy) ? header->nodeCount : 0; /* positions in the hierarchy */
+
+	sizes[SNAPSHOT_IDS] = (uint64_t)header->nodeCount * sizeof(uint32_t);
+	sizes[SNAPSHOT_SAVEHOUSE_BITS] = (((uint64_t)header->nodeCount + 63) >> 6) * sizeof(uint64_t);
+	sizes[SNAPSHOT_OUT_OFFSETS] = sizes[SNAPSHOT_IN_OFFSETS] = ((uint64_t)header->nodeCount + 1) * sizeof(uint32_t);
+	sizes[SNAPSHOT_OUT_NEIGHBOURS] = sizes[SNAPSHOT_IN_NEIGHBOURS] = (uint64_t)header->edgeCount * sizeof(neighbour_t); /* target and weight next to each other */
+	sizes[SNAPSHOT_SAVEHOUSES] = (uint64_t)header->saveHouseCount * sizeof(uint32_t);
+	sizes[SNAPSHOT_ORDER] = levels * sizeof(uint32_t);
+	sizes[SNAPSHOT_UP_OFFSETS] = sizes[SNAPSHOT_DOWN_OFFSETS] = (0 != levels) ? (levels + 1) * sizeof(uint32_t) : 0;
+	sizes[SNAPSHOT_UP_NEIGHBOURS] = (uint64_t)header->upCount * sizeof(neighbour_t);
+	sizes[SNAPSHOT_DOWN_NEIGHBOURS] = (uint64_t)header->downCount * sizeof(neighbour_t);
+}
+
+void snapshotArrays(graph_t *__restrict graph, void ***__restrict arrays)
+{
+	arrays[SNAPSHOT_IDS] = (void**)&graph->ids;
+	arrays[SNAPSHOT_SAVEHOUSE_BITS] = (void**)&graph->saveHouseBits;
+	arrays[SNAPSHOT_OUT_OFFSETS] = (void**)&graph->out.offsets;
+	arrays[SNAPSHOT_OUT_NEIGHBOURS] = (void**)&graph->out.neighbours;
+	arrays[SNAPSHOT_IN_OFFSETS] = (void**)&graph->in.offsets;
+	arrays[SNAPSHOT_IN_NEIGHBOURS] = (void**)&graph->in.neighbours;
+	arrays[SNAPSHOT_SAVEHOUSES] = (void**)&graph->saveHouses.data;
+	arrays[SNAPSHOT_ORDER] = (void**)&graph->hierarchy.order;
+	arrays[SNAPSHOT_UP_OFFSETS] = (void**)&graph->hierarchy.up.offsets;
+	arrays[SNAPSHOT_UP_NEIGHBOURS] = (void**)&graph->hierarchy.up.neighbours;
+	arrays[SNAPSHOT_DOWN_OFFSETS] = (void**)&graph->hierarchy.down.offsets;
+	arrays[SNAPSHOT_DOWN_NEIGHBOURS] = (void**)&graph->hierarchy.down.neighbours;
+}
+
+bool writeSnapshot(const char *__restrict path, graph_t *__restrict graph)
+{   /* the header and then every array of the graph as it is, so loading is just mapping the file (same byte order only) */
+	static const char padding[SNAPSHOT_ALIGNMENT] = { 0 };
+
+	void **sections[SNAPSHOT_SECTIONS];
+	snapshotArrays(graph, sections);
+
+	snapshotHeader_t header;
+	fillSnapshotHeader(graph, &header);
+
+	uint64_t sizes[SNAPSHOT_SECTIONS];
+	snapshotSectionSizes(&header, sizes);
+
+	uint64_t position = sizeof(header);
+	for (uint32_t i = 0; i < SNAPSHOT_SECTIONS; i++)
+	{
+		position = (position + SNAPSHOT_ALIGNMENT - 1) & ~(uint64_t)(SNAPSHOT_ALIGNMENT - 1);
+		header.offsets[i] = position;
+		position += sizes[i];
+	}
+
+	header.fileSize = position;
+
+	FILE *file = fopen(path, "wb");
+
+	if (NULL == file) return false;
+
+	bool written = (1 == fwrite(&header, sizeof(header), 1, file));
+	position = sizeof(header);
+
+	for (uint32_t i = 0; i < SNAPSHOT_SECTIONS && written; i++)
+	{
+		size_t gap = (size_t)(header.offsets[i] - position); /* always < SNAPSHOT_ALIGNMENT */
+
+		written = (gap == fwrite(padding, 1, gap, file)) && (0 == sizes[i] || 1 == fwrite(*sections[i], (size_t)sizes[i], 1, file));
+		position = header.offsets[i] + sizes[i];
+	}
+
+	written = (0 == fclose(file)) && written;
+
+	if (!written) remove(path); /* do not leave half a snapshot behind */
+
+	return written;
+}
+
+int loadSnapshot(const char *__restrict path, graph_t *__restrict graph)
+{   /* checks the header and points the graph into the mapped file, the file has to stay unchanged while it is in use.
+	   the mapping is private, so updates in server mode can change it without changing the file */
+	memset(graph, 0, sizeof(graph_t));
+
+	FILE *file = fopen(path, "rb");
+
+	if (NULL == file) return RESULT_FILE_ERR;
+
+	snapshotHeader_t header;
+
+	bool valid = (1 == fread(&header, sizeof(header), 1, file)) && 0 == memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) &&
+		SNAPSHOT_VERSION == header.version && SNAPSHOT_BYTE_ORDER == header.byteOrder && header.nodeCount > 0 &&
+		header.fileSize <= SIZE_MAX && header.startID < MAX_ID && header.endID < MAX_ID && header.distance < MAX_ID &&
+		(1 == header.hierarchy || (0 == header.hierarchy && 0 == header.upCount && 0 == header.downCount));
+
+#if POSIX_AVAILABLE
+	struct stat info;
+	valid = valid && 0 == fstat(fileno(file), &info) && (uint64_t)info.st_size == header.fileSize;
+
+	if (valid)
+	{
+		void *mapping = mmap(NULL, (size_t)header.fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0); /* (pages get copied when written) */
+
+		if (MAP_FAILED == mapping)
+		{
+			fclose(file);
+			return RESULT_MALLOC_ERR;
+		}
+
+		graph->snapshot = mapping;
+	}
+#else
+	valid = valid && 0 == fseek(file, 0, SEEK_END) && (uint64_t)ftell(file) == header.fileSize && 0 == fseek(file, 0, SEEK_SET);
+
+	if (valid) /* no mmap, so read it in one piece */
+	{
+		graph->snapshot = malloc((size_t)header.fileSize);
+
+		if (NULL == graph->snapshot)
+		{
+			fclose(file);
+			return RESULT_MALLOC_ERR;
+		}
+
+		valid = (1 == fread(graph->snapshot, (size_t)header.fileSize, 1, file));
+	}
+#endif
+
+	fclose(file); /* (the mapping stays valid without the file) */
+
+	graph->snapshotSize = (size_t)header.fileSize;
+
+	if (!valid)
+	{
+		freeGraph(graph);
+		return RESULT_SNAPSHOT_ERR;
+	}
+
+	uint64_t sizes[SNAPSHOT_SECTIONS];
+	snapshotSectionSizes(&header, sizes);
+
+	for (uint32_t i = 0; i < SNAPSHOT_SECTIONS; i++) /* every section has to be aligned and inside of the file */
+	{
+		if (0 != header.offsets[i] % SNAPSHOT_ALIGNMENT || header.offsets[i] < sizeof(header) ||
+			header.offsets[i] > header.fileSize || sizes[i] > header.fileSize - header.offsets[i])
+		{
+			freeGraph(graph);
+			return RESULT_SNAPSHOT_ERR;
+		}
+	}
+
+	char *base = (char*)graph->snapshot;
+
+	graph->count = header.nodeCount;
+	graph->ids = (uint32_t*)(base + header.offsets[SNAPSHOT_IDS]);
+	graph->saveHouseBits = (uint64_t*)(base + header.offsets[SNAPSHOT_SAVEHOUSE_BITS]);
+	graph->out.count = graph->in.count = header.edgeCount;
+	graph->out.offsets = (uint32_t*)(base + header.offsets[SNAPSHOT_OUT_OFFSETS]);
+	graph->out.neighbours = (neighbour_t*)(base + header.offsets[SNAPSHOT_OUT_NEIGHBOURS]);
+	graph->in.offsets = (uint32_t*)(base + header.offsets[SNAPSHOT_IN_OFFSETS]);
+	graph->in.neighbours = (neighbour_t*)(base + header.offsets[SNAPSHOT_IN_NEIGHBOURS]);
+	graph->saveHouses.count = graph->saveHouses.limit = header.saveHouseCount;
+	graph->saveHouses.data = (uint32_t*)(base + header.offsets[SNAPSHOT_SAVEHOUSES]);
+
+	if (0 != header.hierarchy) /* it was exported with --search=hierarchy */
+	{
+		graph->hierarchy.order = (uint32_t*)(base + header.offsets[SNAPSHOT_ORDER]);
+		graph->hierarchy.up.count = header.upCount;
+		graph->hierarchy.up.offsets = (uint32_t*)(base + header.offsets[SNAPSHOT_UP_OFFSETS]);
+		graph->hierarchy.up.neighbours = (neighbour_t*)(base + header.offsets[SNAPSHOT_UP_NEIGHBOURS]);
+		graph->hierarchy.down.count = header.downCount;
+		graph->hierarchy.down.offsets = (uint32_t*)(base + header.offsets[SNAPSHOT_DOWN_OFFSETS]);
+		graph->hierarchy.down.neighbours = (neighbour_t*)(base + header.offsets[SNAPSHOT_DOWN_NEIGHBOURS]);
+		graph->hierarchy.mapped = true;
+	}
+
+	/* the contents are trusted (looking at every edge would cost as much as building the graph), only the ends of the lists are checked */
+	if (0 != graph->out.offsets[0] || header.edgeCount != graph->out.offsets[header.nodeCount] ||
+		0 != graph->in.offsets[0] || header.edgeCount != graph->in.offsets[header.nodeCount] ||
+		(0 != header.hierarchy && (0 != graph->hierarchy.up.offsets[0] || header.upCount != graph->hierarchy.up.offsets[header.nodeCount] ||
+		0 != graph->hierarchy.down.offsets[0] || header.downCount != graph->hierarchy.down.offsets[header.nodeCount])))
+	{
+		freeGraph(graph);
+		return RESULT_SNAPSHOT_ERR;
+	}
+
+	globalStartID = header.startID; /* the one-shot query is the one of the original input */
+	globalEndID = header.endID;
+	globalDistance = header.distance;
+
+	return RESULT_OK;
+}
+
+bool detachSnapshot(graph_t *graph)
+{   /* every array gets its own memory like in a built graph (only needed when one of them has to grow) */
+	if (NULL == graph->snapshot) return true;
+
+	snapshotHeader_t header; /* (the counts are still the ones of the file) */
+	fillSnapshotHeader(graph, &header);
+
+	if (!graph->hierarchy.mapped) header.hierarchy = header.upCount = header.downCount = 0; /* one built after loading is allocated allready */
+
+	uint64_t sizes[SNAPSHOT_SECTIONS];
+	void **arrays[SNAPSHOT_SECTIONS];
+	void *copies[SNAPSHOT_SECTIONS];
+
+	snapshotSectionSizes(&header, sizes);
+	snapshotArrays(graph, arrays);
+
+	bool copied = true;
+
+	for (uint32_t i = 0; i < SNAPSHOT_SECTIONS; i++)
+	{
+		if (0 == sizes[i] && (SNAPSHOT_ORDER <= i && 0 == header.hierarchy))
+		{
+			copies[i] = *arrays[i]; /* no hierarchy or not in the snapshot */
+			continue;
+		}
+
+		copies[i] = malloc(sizes[i] > 0 ? (size_t)sizes[i] : 1);
+
+		if (NULL == copies[i]) copied = false;
+		else if (sizes[i] > 0) memcpy(copies[i], *arrays[i], (size_t)sizes[i]);
+	}
+
+	if (!copied)
+	{
+		for (uint32_t i = 0; i < SNAPSHOT_SECTIONS; i++) if (SNAPSHOT_ORDER > i || 0 != header.hierarchy) free(copies[i]);
+
+		return false;
+	}
+
+#if POSIX_AVAILABLE
+	munmap(graph->snapshot, graph->snapshotSize);
+#else
+	free(graph->snapshot);
+#endif
+
+	for (uint32_t i = 0; i < SNAPSHOT_SECTIONS; i++) *arrays[i] = copies[i];
+
+	graph->saveHouses.limit = graph->saveHouses.count;
+	graph->hierarchy.mapped = false;
+	graph->snapshot = NULL;
+	graph->snapshotSize = 0;
+
+	return true;
+}
+/*====SNAPSHOT ROUTINES========================================================*/
+
+
+/*====HEAP ROUTINES============================================================*/
+bool insertNodeToHeap(vertices_t *__restrict vertices, heap_t *__restrict heap, const uint32_t element)
+{
+	if (INFINITY32 != heap->positions[element]) /* check if the element is in the heap allready */
+	{
+		siftUpHeap(vertices, heap, heap->positions[element]); /* if yes just update the position */
+
+		return true;
+	}
+
+	if (heap->count == heap->limit) /* if the memory limit is reached */
+	{
+		heap->limit = heap->limit << 1; /* increase memory limit */
+
+		uint32_t *temp = (uint32_t*)calloc(heap->limit, sizeof(uint32_t)); /* get new memory in bigger size */
+
+		if (NULL == temp) return false; /* check if that worked */
+
+		memcpy(temp, heap->data, sizeof(uint32_t) * heap->count); /* copy the data to the new array */
+		free(heap->data); /* delete the old array */
+		heap->data = temp; /* adjust the pointers */
+	}
+
+	heap->positions[element] = heap->count;
+	heap->data[heap->count] = element; /* set the last item to the new element */
+	siftUpHeap(vertices, heap, heap->count); /* sift-up the element */
+
+	heap->count++; /* increment the count of elements */
+
+	return true;
+}
+
+uint32_t removeMinNodeFromHeap(vertices_t *__restrict vertices, heap_t *__restrict heap)
+{
+	if (0 == heap->count) return INFINITY32;
+
+	uint32_t result = heap->data[0]; /* remove first item (the smallest) */
+
+	heap->count--;
+
+	heap->data[0] = heap->data[heap->count]; /* set new root to the very last element (also decrement size) */
+	heap->positions[heap->data[0]] = 0; /* mark position as free */
+	siftDownHeap(vertices, heap, 0); /* restore the heap properties starting from the new root  and update position */
+
+	heap->positions[result] = INFINITY32; /* mark returned item as deleted */
+
+	return result; /* return the value */
+}
+
+void siftDownHeap(vertices_t *__restrict vertices, heap_t *__restrict heap, uint32_t index)
+{
+	const uint32_t *distances = vertices->distances;
+	uint32_t minimum = index; /* assume the root is the biggest */
+	while (true)
+	{
+		register uint32_t left = LEFT(index);
+		if (left < heap->count) /* compare with left child */
+		{
+			if (distances[heap->data[left]] < distances[heap->data[minimum]])
+				minimum = left;
+
+			register uint32_t right = RIGHT(index);
+			/* if the left children does not exists the right children can not exist */
+			if (right < heap->count && distances[heap->data[right]] < distances[heap->data[minimum]]) /* compare with right child */
+				minimum = right;
+		}
+
+		if (minimum == index) return;
+
+		/* if the assumetion was wrong */
+		register uint32_t t = heap->data[index]; /* just swap the parent with the smaller child */
+		heap->data[index] = heap->data[minimum];
+		heap->data[minimum] = t;
+
+		t = heap->positions[heap->data[index]];
+		heap->positions[heap->data[index]] = heap->positions[heap->data[minimum]];
+		heap->positions[heap->data[minimum]] = t;
+
+		index = minimum; /* go one layer down */
+	}
+}
+
+void siftUpHeap(vertices_t *__restrict vertices, heap_t *__restrict heap, uint32_t index)
+{
+	const uint32_t *distances = vertices->distances;
+
+	while (true)
+	{
+		if (0 == index) return; /* abort when we reach the root */
+
+		register uint32_t parent = PARENT(index);
+
+		if (distances[heap->data[index]] >= distances[heap->data[parent]]) return; /* abort when we reached our final position */
+
+		register uint32_t t = heap->data[index]; /* swap the node with its parent */
+		heap->data[index] = heap->data[parent];
+		heap->data[parent] = t;
+
+		t = heap->positions[heap->data[index]]; /* also swap the positions they are registered in */
+		heap->positions[heap->data[index]] = heap->positions[heap->data[parent]];
+		heap->positions[heap->data[parent]] = t;
+
+		index = parent; /* go one layer up */
+	}
+}
+bool insertNodeToRadixHeap(radixHeap_t *__restrict heap, const uint32_t index, const uint32_t key)
+{
+	radixBucket_t *bucket = &heap->buckets[bitLength(key ^ heap->last)]; /* 0 if key == last */
+
+	if (bucket->count == bucket->limit) /* grow the bucket */
+	{
+		uint32_t limit = (0 == bucket->limit) ? MEMORY_START_SIZE : bucket->limit << 1;
+		radixEntry_t *temp = (radixEntry_t*)realloc(bucket->data, sizeof(radixEntry_t) * limit);
+
+		if (NULL == temp) return false;
+
+		bucket->data = temp;
+		bucket->limit = limit;
+	}
+
+	bucket->data[bucket->count].key = key;
+	bucket->data[bucket->count].index = index;
+	bucket->count++;
+	heap->count++;
+
+	return true;
+}
+
+uint32_t removeMinNodeFromRadixHeap(vertices_t *__restrict vertices, radixHeap_t *__restrict heap)
+{
+	while (heap->count > 0)
+	{
+		radixBucket_t *first = &heap->buckets[0];
+
+		if (0 == first->count) /* refill bucket 0 from the first non empty bucket */
+		{
+			uint32_t i = 1;
+			while (0 == heap->buckets[i].count) i++;
+
+			radixBucket_t *bucket = &heap->buckets[i];
+
+			uint32_t minimum = bucket->data[0].key; /* the new last is the smallest key in there */
+			for (uint32_t j = 1; j < bucket->count; j++) if (bucket->data[j].key < minimum) minimum = bucket->data[j].key;
+
+			heap->last = minimum;
+
+			/* every entry goes to a lower bucket now (they all share the bits above i - 1 with the new last) */
+			for (uint32_t j = 0; j < bucket->count; j++)
+			{
+				radixBucket_t *target = &heap->buckets[bitLength(bucket->data[j].key ^ minimum)];
+
+				if (target->count == target->limit)
+				{
+					uint32_t limit = (0 == target->limit) ? MEMORY_START_SIZE : target->limit << 1;
+					radixEntry_t *temp = (radixEntry_t*)realloc(target->data, sizeof(radixEntry_t) * limit);
+
+					if (NULL == temp) /* can not continue */
+					{
+						heap->failed = true;
+						return INFINITY32;
+					}
+
+					target->data = temp;
+					target->limit = limit;
+				}
+
+				target->data[target->count++] = bucket->data[j];
+			}
+
+			bucket->count = 0;
+		}
+
+		radixEntry_t entry = first->data[--first->count];
+		heap->count--;
+
+		/* skip entries of nodes that were visited or got a smaller distance later on */
+		if (!TEST_BIT(vertices->visited, entry.index) && vertices->distances[entry.index] == entry.key) return entry.index;
+	}
+
+	return INFINITY32;
+}
+
+void insertNodeToBucketQueue(bucketQueue_t *__restrict queue, const uint32_t index, const uint32_t key, const uint32_t oldKey)
+{
+	if (INFINITY32 != oldKey) /* it is in the queue allready, so take it out of the old bucket */
+	{
+		if (INFINITY32 == queue->previous[index]) queue->heads[oldKey] = queue->next[index];
+		else queue->next[queue->previous[index]] = queue->next[index];
+
+		if (INFINITY32 != queue->next[index]) queue->previous[queue->next[index]] = queue->previous[index];
+
+		queue->count--;
+	}
+
+	queue->previous[index] = INFINITY32; /* put it in front of its new bucket */
+	queue->next[index] = queue->heads[key];
+
+	if (INFINITY32 != queue->heads[key]) queue->previous[queue->heads[key]] = index;
+
+	queue->heads[key] = index;
+	queue->count++;
+
+	if (key < queue->current) queue->current = key;
+}
+
+uint32_t removeMinNodeFromBucketQueue(bucketQueue_t *queue)
+{
+	if (0 == queue->count) return INFINITY32;
+
+	while (INFINITY32 == queue->heads[queue->current]) queue->current++; /* distances only grow, so this never goes back */
+
+	uint32_t result = queue->heads[queue->current];
+
+	queue->heads[queue->current] = queue->next[result];
+	if (INFINITY32 != queue->next[result]) queue->previous[queue->next[result]] = INFINITY32;
+
+	queue->count--;
+
+	return result;
+}
+
+bool createQueue(queue_t *__restrict queue, const uint32_t count, const uint64_t limit)
+{
+	memset(queue, 0, sizeof(queue_t));
+
+	queue->type = queueType;
+
+	if (QUEUE_AUTO == queue->type) /* buckets if there are not much more of them than nodes, radix heap otherwise */
+		queue->type = (limit < BUCKET_QUEUE_LIMIT && limit <= 4 * (uint64_t)count) ? QUEUE_BUCKET : QUEUE_RADIX;
+
+	if (QUEUE_BUCKET == queue->type && limit >= BUCKET_QUEUE_LIMIT) queue->type = QUEUE_RADIX; /* too many buckets */
+
+	switch (queue->type)
+	{
+	case QUEUE_BUCKET:
+		queue->bucket.bucketCount = (uint32_t)limit + 1;
+		queue->bucket.heads = (uint32_t*)malloc(sizeof(uint32_t) * queue->bucket.bucketCount);
+		queue->bucket.next = (uint32_t*)malloc(sizeof(uint32_t) * count);
+		queue->bucket.previous = (uint32_t*)malloc(sizeof(uint32_t) * count);
+
+		if (NULL == queue->bucket.heads || NULL == queue->bucket.next || NULL == queue->bucket.previous) return false;
+
+		memset(queue->bucket.heads, 0xFF, sizeof(uint32_t) * queue->bucket.bucketCount); /* all empty (INFINITY32) */
+		return true;
+	case QUEUE_RADIX:
+		return true; /* the buckets grow when they are needed */
+	case QUEUE_BINARY:
+	default:
+		queue->type = QUEUE_BINARY;
+		queue->heap.count = 0;
+		queue->heap.limit = count / 2; /* TODO: find good start size */
+		if (queue->heap.limit == 0) queue->heap.limit = 2;
+		queue->heap.data = (uint32_t*)calloc(queue->heap.limit, sizeof(uint32_t));
+
+		queue->heap.positions = (uint32_t*)malloc(count * sizeof(uint32_t)); /* positions saves the index in the heap array of each possible item */
+
+		if (NULL == queue->heap.positions || NULL == queue->heap.data) return false; /* check if the allocations worked */
+
+		memset(queue->heap.positions, 0xFF, count * sizeof(uint32_t)); /* initalize the positions-array to all be infinity (not in heap) */
+		return true;
+	}
+}
+
+bool insertNodeToQueue(vertices_t *__restrict vertices, queue_t *__restrict queue, const uint32_t index, const uint32_t oldDistance)
+{
+	return pushNode(vertices, queue, queue->type, index, oldDistance);
+}
+
+uint32_t removeMinNodeFromQueue(vertices_t *__restrict vertices, queue_t *__restrict queue)
+{
+	return popNode(vertices, queue, queue->type);
+}
+
+ALWAYS_INLINE bool pushNode(vertices_t *__restrict vertices, queue_t *__restrict queue, const uint32_t type, const uint32_t index, const uint32_t oldDistance)
+{   /* with a constant type only one case is left */
+	switch (type)
+	{
+	case QUEUE_BUCKET:
+		insertNodeToBucketQueue(&queue->bucket, index, vertices->distances[index], oldDistance);
+		return true;
+	case QUEUE_RADIX:
+		return insertNodeToRadixHeap(&queue->radix, index, vertices->distances[index]);
+	default:
+		return insertNodeToHeap(vertices, &queue->heap, index);
+	}
+}
+
+ALWAYS_INLINE uint32_t popNode(vertices_t *__restrict vertices, queue_t *__restrict queue, const uint32_t type)
+{
+	switch (type)
+	{
+	case QUEUE_BUCKET:
+		return removeMinNodeFromBucketQueue(&queue->bucket);
+	case QUEUE_RADIX:
+		return removeMinNodeFromRadixHeap(vertices, &queue->radix);
+	default:
+		return removeMinNodeFromHeap(vertices, &queue->heap);
+	}
+}
+
+void freeQueue(queue_t *queue)
+{
+	if (NULL != queue->heap.data) free(queue->heap.data); /* free heap if neccessary */
+	if (NULL != queue->heap.positions) free(queue->heap.positions);
+
+	for (uint32_t i = 0; i < RADIX_HEAP_BUCKETS; i++) if (NULL != queue->radix.buckets[i].data) free(queue->radix.buckets[i].data);
+
+	if (NULL != queue->bucket.heads) free(queue->bucket.heads);
+	if (NULL != queue->bucket.next) free(queue->bucket.next);
+	if (NULL != queue->bucket.previous) free(queue->bucket.previous);
+
+	memset(queue, 0, sizeof(queue_t));
+}
+/*====HEAP ROUTINES============================================================*/
+
+
+/*====DIJKSTRA ROUTINE=========================================================*/
+bool createSearch(search_t *__restrict search, graph_t *__restrict graph, adjacency_t *__restrict adjacency, const uint32_t startIndex, const uint64_t limit)
+{
+	search->graph = graph;
+	search->adjacency = adjacency;
+	search->startIndex = startIndex;
+	search->limit = limit;
+	search->success = false;
+	search->targets = NULL;
+	search->targetCount = 0;
+	search->pops = search->relaxed = search->pushes = search->decreaseKeys = 0;
+	search->vertices.distances = (uint32_t*)malloc(sizeof(uint32_t) * (graph->count > 0 ? graph->count : 1));
+	search->vertices.visited = (uint64_t*)calloc(graph->count > 0 ? BITMAP_WORDS(graph->count) : 1, sizeof(uint64_t));
+	search->reached = (uint64_t*)calloc(graph->count > 0 ? BITMAP_WORDS(graph->count) : 1, sizeof(uint64_t));
+
+	if (NULL == search->vertices.distances || NULL == search->vertices.visited || NULL == search->reached) return false;
+
+	memset(search->vertices.distances, 0xFF, sizeof(uint32_t) * graph->count); /* set distance from the start to INFINITY (INFINITY32) */
+
+	return true;
+}
+
+void *runSearch(void *argument)
+{
+	search_t *search = (search_t*)argument;
+
+	graph_t *graph = search->graph;
+
+	/* with the same weight on every edge the queue is not needed (unless one was asked for), but the levels need the edges of
+	   both directions in blocks */
+	bool hops = WEIGHTS_MIXED != graph->hopWeight && QUEUE_AUTO == queueType && NULL != graph->out.neighbours && NULL != graph->in.neighbours &&
+		NULL == graph->out.packed && NULL == graph->in.packed;
+
+	if (SEARCH_HIERARCHY == searchType && NULL != graph->hierarchy.order) search->success = phast(search);
+	else if (SEARCH_DELTA == searchType) search->success = deltaStepping(search);
+	else search->success = hops ? breadthFirst(search) : dijkstra(search);
+
+	return NULL;
+}
+
+bool dijkstra(search_t *search)
+{   /* every queue type gets its own copy of the kernel for every storage, so the inner loop has no switch and no check for the
+	   storage left */
+	queue_t queue; /* create new queue for dijkstra */
+
+	if (!createQueue(&queue, search->graph->count, search->limit))
+	{
+		freeQueue(&queue);
+
+		return false;
+	}
+
+	bool success;
+
+	if (NULL != search->adjacency->pager) success = dijkstraQueue(search, &queue, STORAGE_PAGED);
+	else if (NULL != search->adjacency->packed) success = dijkstraQueue(search, &queue, STORAGE_PACKED);
+	else success = dijkstraQueue(search, &queue, STORAGE_BLOCKS);
+
+	freeQueue(&queue);
+
+	return success;
+}
+
+ALWAYS_INLINE bool dijkstraQueue(search_t *__restrict search, queue_t *__restrict queue, const uint32_t storage)
+{   /* (the distances stay 32 bits wide for every queue: limits are < MAX_ID, and 16 bits for small limits did not make a bucket
+	   queue search faster, its lists take three times the space of the distances anyway) */
+	if (QUEUE_BUCKET == queue->type) return dijkstraKernel(search, queue, QUEUE_BUCKET, storage);
+	if (QUEUE_RADIX == queue->type) return dijkstraKernel(search, queue, QUEUE_RADIX, storage);
+
+	return dijkstraKernel(search, queue, QUEUE_BINARY, storage);
+}
+
+ALWAYS_INLINE bool dijkstraKernel(search_t *__restrict search, queue_t *__restrict queue, const uint32_t type, const uint32_t storage)
+{   /* nodes further away than limit are never put into the queue, so the search ends as soon as those are all that is left */
+	vertices_t *vertices = &search->vertices;
+	uint32_t *distances = vertices->distances;
+	uint64_t *visited = vertices->visited;
+	const uint32_t *offsets = search->adjacency->offsets;
+	const neighbour_t *neighbours = search->adjacency->neighbours; /* the neighbours of a node are one block in there */
+	const uint64_t limit = search->limit;
+	neighbour_t *unpacked = NULL; /* --compress: the neighbours of the node that is visited */
+	pager_t *pager = (STORAGE_PAGED == storage) ? search->adjacency->pager : NULL; /* --external: they come out of the file one page at a time */
+	const uint64_t *targets = search->targets;
+	uint64_t remaining = search->targetCount; /* targets that are not visited yet */
+	uint64_t pops = 0, relaxed = 0, inserts = 0, pushes = 0; /* (--stats, every insert that is not a push is a decrease-key) */
+
+	if (STORAGE_PACKED == storage)
+	{
+		unpacked = (neighbour_t*)malloc(sizeof(neighbour_t) * ((size_t)search->adjacency->maxDegree + 3));
+
+		if (NULL == unpacked) return false;
+	}
+
+	distances[search->startIndex] = 0; /* the startnode can reach its self in no time */
+
+	if (!pushNode(vertices, queue, type, search->startIndex, INFINITY32)) /* insert the startnode into the queue */
+	{
+		free(unpacked);
+
+		return false;
+	}
+
+	while (1) /* while there are unprocessed nodes we continue */
+	{
+		register uint32_t index = popNode(vertices, queue, type); /* get the next node */
+
+		if (index == INFINITY32) /* nothing left (within limit) */
+		{
+			if (QUEUE_RADIX == type && queue->radix.failed) /* or the radix heap could not grow */
+			{
+				free(unpacked);
+
+				return false;
+			}
+
+			break;
+		}
+
+		SET_BIT(visited, index); /* mark it as visited */
+		SET_BIT(search->reached, index); /* (only nodes within limit get into the queue) */
+		pops++;
+
+		if (NULL != targets && TEST_BIT(targets, index) && 0 == --remaining) break; /* the rest of the graph does not matter */
+
+		uint32_t distance = distances[index];
+		const neighbour_t *source = unpacked; /* the neighbours are source[position] to source[last - 1] */
+		uint32_t position = 0, last;
+
+		if (STORAGE_PACKED != storage)
+		{
+			source = neighbours;
+			position = offsets[index];
+			last = offsets[index + 1];
+		}
+		else last = unpackNeighbours(search->adjacency, index, unpacked);
+
+		while (position < last) /* in one go, only a pager gives them page by page */
+		{
+			uint32_t count = last - position;
+			const neighbour_t *block = (STORAGE_PAGED != storage) ? &source[position] : pageNeighbours(pager, position, &count);
+
+			if (NULL == block) /* the page could not be read */
+			{
+				free(unpacked);
+
+				return false;
+			}
+
+			position += count;
+			relaxed += count;
+
+			for (register uint32_t neighbourIndex = 0; neighbourIndex < count; neighbourIndex++) /* and update distance to all its neighbours */
+			{
+				uint32_t childIndex = block[neighbourIndex].index;
+				uint32_t newDistance = addDistance(distance, block[neighbourIndex].distance); /* calculate new distance */
+				uint32_t oldDistance = distances[childIndex];
+
+				if (newDistance < oldDistance && newDistance <= limit && !TEST_BIT(visited, childIndex)) /* check if distance needs to be updated */
+				{
+					distances[childIndex] = newDistance; /* update if neccessary */
+					inserts++;
+					pushes += (INFINITY32 == oldDistance);
+
+					if (!pushNode(vertices, queue, type, childIndex, oldDistance)) /* put the unseen neighbours into the queue */
+					{
+						free(unpacked);
+
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	search->pops = pops;
+	search->relaxed = relaxed;
+	search->pushes = pushes + 1; /* (the start node) */
+	search->decreaseKeys = inserts - pushes;
+
+	free(unpacked);
+
+	return true;
+}
+
+static inline uint32_t addDistance(const uint32_t distance, const uint32_t weight)
+{   /* every limit is < MAX_ID, so a sum that saturates is never within one (INFINITY32 + anything stays INFINITY32 too) */
+	uint32_t sum = distance + weight;
+
+	return (sum < distance) ? INFINITY32 : sum;
+}
+
+void freeSearch(search_t *search)
+{
+	if (NULL != search->vertices.distances) free(search->vertices.distances);
+	if (NULL != search->vertices.visited) free(search->vertices.visited);
+	if (NULL != search->reached) free(search->reached);
+
+	search->vertices.distances = NULL;
+	search->vertices.visited = NULL;
+	search->reached = NULL;
+}
+/*====DIJKSTRA ROUTINE=========================================================*/
+
+
+/*====BREADTH FIRST ROUTINE====================================================*/
+bool breadthFirst(search_t *search)
+{   /* the distance of a node is its level times hopWeight, so the levels up to limit / hopWeight are the nodes within limit. a level
+	   is found top-down (the edges out of the frontier) or bottom-up (every node that is not reached yet looks for a neighbour in
+	   the frontier through the edges of the other direction), whichever has fewer edges to look at. an edge with another weight
+	   is one that was removed (EDGE_REMOVED) */
+	graph_t *graph = search->graph;
+	const adjacency_t *forward = search->adjacency;
+	const adjacency_t *backward = (forward == &graph->out) ? &graph->in : &graph->out;
+	uint32_t *distances = search->vertices.distances;
+	uint64_t *visited = search->vertices.visited; /* the nodes of all levels so far */
+	const uint32_t weight = graph->hopWeight;
+	const uint64_t levels = search->limit / weight;
+	const size_t words = BITMAP_WORDS(graph->count);
+	uint64_t relaxed = 0;
+
+	uint32_t *nodes = (uint32_t*)malloc(sizeof(uint32_t) * graph->count); /* every node that is reached, level by level */
+	uint64_t *frontier = (uint64_t*)malloc(sizeof(uint64_t) * words); /* the last level as bitmap (for bottom-up) */
+
+	if (NULL == nodes || NULL == frontier)
+	{
+		free(nodes);
+		free(frontier);
+
+		return false;
+	}
+
+	uint32_t first = 0, last = 1; /* the last level is nodes[first] to nodes[last - 1] */
+	nodes[0] = search->startIndex;
+	distances[search->startIndex] = 0;
+	SET_BIT(visited, search->startIndex);
+
+	uint64_t frontierEdges = forward->offsets[search->startIndex + 1] - forward->offsets[search->startIndex];
+	uint64_t unexploredEdges = forward->count - frontierEdges;
+	uint64_t remaining = search->targetCount - (NULL != search->targets && TEST_BIT(search->targets, search->startIndex));
+	bool bottomUp = false;
+
+	for (uint64_t level = 1; level <= levels && first < last && (NULL == search->targets || 0 != remaining); level++)
+	{
+		uint32_t distance = (uint32_t)(level * weight); /* (<= limit) */
+		uint32_t next = last;
+
+		if (!bottomUp && frontierEdges > unexploredEdges / BFS_ALPHA) bottomUp = true;
+		else if (bottomUp && last - first < graph->count / BFS_BETA) bottomUp = false;
+
+		if (bottomUp)
+		{
+			memset(frontier, 0, sizeof(uint64_t) * words);
+
+			for (uint32_t i = first; i < last; i++) SET_BIT(frontier, nodes[i]);
+
+			for (size_t i = 0; i < words; i++)
+			{
+				uint64_t unseen = ~visited[i];
+
+				if (i + 1 == words && 0 != (graph->count & 63)) unseen &= ((uint64_t)1 << (graph->count & 63)) - 1; /* (not a node) */
+
+				for (; 0 != unseen; unseen &= unseen - 1) /* (clears the lowest bit) */
+				{
+					uint32_t index = (uint32_t)((i << 6) | countTrailingZeros64(unseen));
+					uint32_t j = backward->offsets[index], end = backward->offsets[index + 1];
+
+					while (j < end && (!TEST_BIT(frontier, backward->neighbours[j].index) || weight != backward->neighbours[j].distance)) j++;
+
+					relaxed += j - backward->offsets[index] + (j < end);
+
+					if (j < end) /* one neighbour is enough */
+					{
+						SET_BIT(visited, index);
+						distances[index] = distance;
+						nodes[next++] = index;
+					}
+				}
+			}
+		}
+		else
+		{
+			for (uint32_t i = first; i < last; i++)
+			{
+				const neighbour_t *neighbour = &forward->neighbours[forward->offsets[nodes[i]]];
+				const neighbour_t *end = &forward->neighbours[forward->offsets[nodes[i] + 1]];
+
+				relaxed += (uint64_t)(end - neighbour);
+
+				for (; neighbour < end; neighbour++)
+				{
+					uint32_t index = neighbour->index;
+
+					if (!TEST_BIT(visited, index) && weight == neighbour->distance)
+					{
+						SET_BIT(visited, index);
+						distances[index] = distance;
+						nodes[next++] = index;
+					}
+				}
+			}
+		}
+
+		frontierEdges = 0;
+
+		for (uint32_t i = last; i < next; i++)
+		{
+			frontierEdges += forward->offsets[nodes[i] + 1] - forward->offsets[nodes[i]];
+			remaining -= (NULL != search->targets && TEST_BIT(search->targets, nodes[i])); /* (a whole level is done, then it stops) */
+		}
+
+		unexploredEdges -= frontierEdges;
+		first = last;
+		last = next;
+	}
+
+	memcpy(search->reached, visited, sizeof(uint64_t) * words); /* every level is within limit */
+
+	search->pops = search->pushes = last;
+	search->relaxed = relaxed;
+	search->decreaseKeys = 0;
+
+	free(nodes);
+	free(frontier);
+
+	return true;
+}
+/*====BREADTH FIRST ROUTINE====================================================*/
+
+
+/*====BATCH ROUTINES===========================================================*/
+bool createBatch(batch_t *__restrict batch, graph_t *__restrict graph, adjacency_t *__restrict adjacency)
+{
+	size_t count = (graph->count > 0) ? graph->count : 1;
+
+	batch->graph = graph;
+	batch->adjacency = adjacency;
+	batch->success = false;
+	batch->pops = batch->relaxed = 0;
+
+	for (uint32_t i = 0; i < BATCH_LANES; i++)
+	{
+		batch->starts[i] = INFINITY32;
+		batch->limits[i] = 0;
+	}
+
+	batch->lanes = (uint32_t*)malloc(sizeof(uint32_t) * BATCH_LANES * count);
+	batch->vertices.distances = (uint32_t*)malloc(sizeof(uint32_t) * count);
+	batch->vertices.visited = (uint64_t*)calloc(BITMAP_WORDS(count), sizeof(uint64_t));
+
+	if (NULL == batch->lanes || NULL == batch->vertices.distances || NULL == batch->vertices.visited) return false;
+
+	memset(batch->lanes, 0xFF, sizeof(uint32_t) * BATCH_LANES * count); /* every lane INFINITY32 */
+	memset(batch->vertices.distances, 0xFF, sizeof(uint32_t) * count); /* not in the queue */
+
+	return true;
+}
+
+void *runBatch(void *argument)
+{
+	batch_t *batch = (batch_t*)argument;
+
+	batch->success = batchSearch(batch);
+
+	return NULL;
+}
+
+bool batchSearch(batch_t *batch)
+{   /* a node is taken out of the queue with the shortest lane that changed since it was last, every lane that changed later is at
+	   least as long, so the keys never go below the last one (the queues of dijkstra work) and a node that is out of the queue
+	   goes back in when one of its lanes gets shorter. the edges of a node are read once for all lanes */
+	vertices_t *vertices = &batch->vertices;
+	uint32_t *lanes = batch->lanes;
+	const uint32_t *offsets = batch->adjacency->offsets;
+	const neighbour_t *neighbours = batch->adjacency->neighbours;
+	uint64_t limit = 0, pops = 0, relaxed = 0;
+
+	if (NULL == neighbours) return false; /* (--compress and --external are for single queries only) */
+
+	for (uint32_t i = 0; i < BATCH_LANES; i++) if (INFINITY32 != batch->starts[i] && batch->limits[i] > limit) limit = batch->limits[i];
+
+	queue_t queue;
+
+	if (!createQueue(&queue, batch->graph->count, limit))
+	{
+		freeQueue(&queue);
+
+		return false;
+	}
+
+	for (uint32_t i = 0; i < BATCH_LANES; i++)
+	{
+		if (INFINITY32 == batch->starts[i]) continue;
+
+		lanes[(size_t)batch->starts[i] * BATCH_LANES + i] = 0;
+
+		if (0 != vertices->distances[batch->starts[i]] && !lowerDistance(vertices, &queue, batch->starts[i], 0)) /* (lanes can share a start) */
+		{
+			freeQueue(&queue);
+
+			return false;
+		}
+	}
+
+	uint32_t index;
+
+	while (INFINITY32 != (index = removeMinNodeFromQueue(vertices, &queue)))
+	{
+		uint32_t current[BATCH_LANES]; /* (a copy, an edge to itself would change them on the way) */
+
+		SET_BIT(vertices->visited, index); /* out of the queue */
+		memcpy(current, &lanes[(size_t)index * BATCH_LANES], sizeof(current));
+		pops++;
+		relaxed += offsets[index + 1] - offsets[index];
+
+		for (uint32_t j = offsets[index]; j < offsets[index + 1]; j++)
+		{
+			uint32_t childIndex = neighbours[j].index;
+			uint32_t key = relaxLanes(&lanes[(size_t)childIndex * BATCH_LANES], current, neighbours[j].distance, batch->limits);
+
+			if (key < vertices->distances[childIndex] || (INFINITY32 != key && TEST_BIT(vertices->visited, childIndex)))
+			{
+				if (!lowerDistance(vertices, &queue, childIndex, key))
+				{
+					freeQueue(&queue);
+
+					return false;
+				}
+			}
+		}
+	}
+
+	bool failed = queue.radix.failed;
+
+	batch->pops = pops;
+	batch->relaxed = relaxed;
+
+	freeQueue(&queue);
+
+	return !failed;
+}
+
+static inline uint32_t relaxLanes(uint32_t *__restrict target, const uint32_t *__restrict source, const uint32_t weight, const uint32_t *__restrict limits)
+{   /* target = min(target, source + weight) in every lane, a sum over the limit of its lane is INFINITY32. gives the shortest lane
+	   that changed (INFINITY32 if none did). there are no unsigned compares before AVX-512, so both sides get their top bit flipped */
+#if AVX2_AVAILABLE
+	const __m256i flip = _mm256_set1_epi32((int)0x80000000);
+	__m256i from = _mm256_loadu_si256((const __m256i*)source);
+	__m256i sum = _mm256_add_epi32(from, _mm256_set1_epi32((int)weight));
+
+	sum = _mm256_or_si256(sum, _mm256_cmpgt_epi32(_mm256_xor_si256(from, flip), _mm256_xor_si256(sum, flip))); /* (overflow) */
+	sum = _mm256_or_si256(sum, _mm256_cmpgt_epi32(_mm256_xor_si256(sum, flip), _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)limits), flip)));
+
+	__m256i old = _mm256_loadu_si256((const __m256i*)target);
+	__m256i shorter = _mm256_cmpgt_epi32(_mm256_xor_si256(old, flip), _mm256_xor_si256(sum, flip));
+
+	if (0 == _mm256_movemask_epi8(shorter)) return INFINITY32; /* (most of the time) */
+
+	_mm256_storeu_si256((__m256i*)target, _mm256_min_epu32(old, sum));
+
+	uint32_t changed[BATCH_LANES];
+	_mm256_storeu_si256((__m256i*)changed, _mm256_or_si256(sum, _mm256_xor_si256(shorter, _mm256_set1_epi32(-1)))); /* the others INFINITY32 */
+#elif SIMD_AVAILABLE
+	const __m128i flip = _mm_set1_epi32((int)0x80000000);
+	const __m128i step = _mm_set1_epi32((int)weight);
+	__m128i shorter[2], sum[2];
+	int mask = 0;
+
+	for (uint32_t half = 0; half < 2; half++)
+	{
+		__m128i from = _mm_loadu_si128((const __m128i*)&source[half * 4]);
+		__m128i old = _mm_loadu_si128((const __m128i*)&target[half * 4]);
+
+		sum[half] = _mm_add_epi32(from, step);
+		sum[half] = _mm_or_si128(sum[half], _mm_cmpgt_epi32(_mm_xor_si128(from, flip), _mm_xor_si128(sum[half], flip))); /* (overflow) */
+		sum[half] = _mm_or_si128(sum[half], _mm_cmpgt_epi32(_mm_xor_si128(sum[half], flip), _mm_xor_si128(_mm_loadu_si128((const __m128i*)&limits[half * 4]), flip)));
+		shorter[half] = _mm_cmpgt_epi32(_mm_xor_si128(old, flip), _mm_xor_si128(sum[half], flip));
+		mask |= _mm_movemask_epi8(shorter[half]);
+	}
+
+	if (0 == mask) return INFINITY32; /* (most of the time) */
+
+	uint32_t changed[BATCH_LANES];
+
+	for (uint32_t half = 0; half < 2; half++)
+	{
+		__m128i old = _mm_loadu_si128((const __m128i*)&target[half * 4]);
+
+		/* no unsigned min in SSE2: take sum where it is shorter */
+		_mm_storeu_si128((__m128i*)&target[half * 4], _mm_or_si128(_mm_and_si128(shorter[half], sum[half]), _mm_andnot_si128(shorter[half], old)));
+		_mm_storeu_si128((__m128i*)&changed[half * 4], _mm_or_si128(sum[half], _mm_andnot_si128(shorter[half], _mm_set1_epi32(-1))));
+	}
+#else
+	uint32_t changed[BATCH_LANES];
+	bool any = false;
+
+	for (uint32_t i = 0; i < BATCH_LANES; i++)
+	{
+		uint32_t sum = addDistance(source[i], weight);
+
+		changed[i] = INFINITY32;
+
+		if (sum <= limits[i] && sum < target[i])
+		{
+			target[i] = changed[i] = sum;
+			any = true;
+		}
+	}
+
+	if (!any) return INFINITY32;
+#endif
+
+	uint32_t shortest = changed[0];
+
+	for (uint32_t i = 1; i < BATCH_LANES; i++) if (changed[i] < shortest) shortest = changed[i];
+
+	return shortest;
+}
+
+void freeBatch(batch_t *batch)
+{
+	if (NULL != batch->lanes) free(batch->lanes);
+	if (NULL != batch->vertices.distances) free(batch->vertices.distances);
+	if (NULL != batch->vertices.visited) free(batch->vertices.visited);
+
+	batch->lanes = NULL;
+	batch->vertices.distances = NULL;
+	batch->vertices.visited = NULL;
+}
+/*====BATCH ROUTINES===========================================================*/
+
+
+/*====DELTA-STEPPING ROUTINES==================================================*/
+bool appendDeltaEntry(deltaList_t *__restrict list, const uint32_t index, const uint32_t distance)
+{
+	if (list->count == list->limit)
+	{
+		uint32_t newLimit = (0 == list->limit) ? MEMORY_START_SIZE : list->limit << 1;
+		deltaEntry_t *temp = (deltaEntry_t*)realloc(list->data, sizeof(deltaEntry_t) * newLimit);
+
+		if (NULL == temp) return false;
+
+		list->data = temp;
+		list->limit = newLimit;
+	}
+
+	list->data[list->count].index = index;
+	list->data[list->count].distance = distance;
+	list->count++;
+
+	return true;
+}
+
+uint32_t chooseDelta(adjacency_t *__restrict adjacency, const uint64_t limit)
+{   /* --delta or the mean weight of some edges spread over the graph, but at least so big that limit / delta fits the buckets */
+	uint64_t delta = deltaValue;
+
+	if (0 == delta && adjacency->count > 0)
+	{
+		uint32_t step = (adjacency->count > DELTA_SAMPLE) ? adjacency->count / DELTA_SAMPLE : 1;
+		uint64_t sum = 0, samples = 0;
+
+		for (uint32_t i = 0; i < adjacency->count; i += step, samples++)
+		{
+			sum += (adjacency->neighbours[i].distance < limit) ? adjacency->neighbours[i].distance : limit; /* longer ones are never used */
+		}
+
+		delta = sum / samples;
+	}
+
+	uint64_t minimum = limit / DELTA_BUCKETS_MAX + 1;
+
+	if (delta < minimum) delta = minimum;
+
+	return (delta > INFINITY32 - 1) ? INFINITY32 - 1 : (uint32_t)delta;
+}
+
+#if POSIX_AVAILABLE
+static bool waitDeltaGate(deltaShared_t *shared)
+{   /* the workers only start once every thread is running, otherwise the barriers would wait forever */
+	pthread_mutex_lock(&shared->mutex);
+	while (DELTA_GATE_CLOSED == shared->gate) pthread_cond_wait(&shared->condition, &shared->mutex);
+	bool open = (DELTA_GATE_OPEN == shared->gate);
+	pthread_mutex_unlock(&shared->mutex);
+
+	return open;
+}
+
+static void waitDeltaBarrier(deltaShared_t *shared)
+{   /* everything written before this is seen by every thread after it */
+	pthread_mutex_lock(&shared->mutex);
+
+	uint32_t generation = shared->generation;
+
+	if (++shared->waiting == shared->threads)
+	{
+		shared->waiting = 0;
+		shared->generation++;
+		pthread_cond_broadcast(&shared->condition);
+	}
+	else while (generation == shared->generation) pthread_cond_wait(&shared->condition, &shared->mutex);
+
+	pthread_mutex_unlock(&shared->mutex);
+}
+
+static void relaxDeltaEdges(deltaWorker_t *worker, const uint32_t index, const uint32_t distance, const bool light)
+{   /* turns the light (<= delta) or heavy edges of a node into requests to the threads that own the neighbours */
+	deltaShared_t *shared = worker->shared;
+	const uint32_t *offsets = shared->adjacency->offsets;
+	const neighbour_t *neighbours = shared->adjacency->neighbours;
+	deltaList_t *requests = &shared->requests[(size_t)worker->id * shared->threads];
+
+	for (uint32_t i = offsets[index]; i < offsets[index + 1]; i++)
+	{
+		if ((neighbours[i].distance <= shared->delta) != light) continue;
+
+		uint32_t child = neighbours[i].index;
+		uint64_t newDistance = (uint64_t)distance + neighbours[i].distance;
+
+		/* only the owner writes distances and not in this phase, so reading them is safe */
+		if (newDistance <= shared->limit && newDistance < shared->distances[child])
+		{
+			if (!appendDeltaEntry(&requests[child % shared->threads], child, (uint32_t)newDistance)) worker->failed = true;
+		}
+	}
+}
+
+static void applyDeltaRequests(deltaWorker_t *worker, uint32_t *lowest)
+{   /* every thread only updates its own nodes, so there is no need for atomics */
+	deltaShared_t *shared = worker->shared;
+
+	for (uint32_t from = 0; from < shared->threads; from++)
+	{
+		deltaList_t *requests = &shared->requests[(size_t)from * shared->threads + worker->id];
+
+		for (uint32_t i = 0; i < requests->count; i++)
+		{
+			deltaEntry_t request = requests->data[i];
+
+			if (request.distance >= shared->distances[request.index]) continue;
+
+			shared->distances[request.index] = request.distance;
+
+			uint32_t bucket = request.distance / shared->delta;
+
+			if (!appendDeltaEntry(&worker->buckets[bucket], request.index, request.distance)) worker->failed = true;
+			if (bucket < *lowest) *lowest = bucket;
+		}
+	}
+}
+
+static void clearDeltaRequests(deltaWorker_t *worker)
+{   /* the requests this thread sent, only after everyone applied them */
+	deltaShared_t *shared = worker->shared;
+
+	for (uint32_t to = 0; to < shared->threads; to++) shared->requests[(size_t)worker->id * shared->threads + to].count = 0;
+}
+
+void *deltaWork(void *argument)
+{   /* one thread of a delta-stepping search, all threads go through the buckets in lockstep */
+	deltaWorker_t *worker = (deltaWorker_t*)argument;
+	deltaShared_t *shared = worker->shared;
+	const uint32_t threads = shared->threads;
+	uint32_t lowest = 0; /* every bucket of this thread below this one is empty */
+
+	if (!waitDeltaGate(shared)) return NULL;
+
+	while (1)
+	{
+		while (lowest < shared->bucketCount && 0 == worker->buckets[lowest].count) lowest++;
+
+		shared->votes[worker->id] = worker->failed ? DELTA_FAILED : lowest;
+		waitDeltaBarrier(shared);
+
+		uint32_t current = shared->bucketCount; /* the smallest non empty bucket of all threads */
+		for (uint32_t i = 0; i < threads; i++)
+		{
+			if (DELTA_FAILED == shared->votes[i]) return NULL; /* every thread sees the same votes, so they all stop */
+			if (shared->votes[i] < current) current = shared->votes[i];
+		}
+
+		if (current == shared->bucketCount) return NULL; /* all buckets are empty, done */
+
+		worker->settled.count = 0;
+
+		while (1) /* light edges can put nodes into the current bucket again, so repeat until it stays empty */
+		{
+			deltaList_t frontier = worker->buckets[current]; /* take the bucket, it gets the (empty) storage of the frontier */
+			worker->buckets[current] = worker->frontier;
+			worker->buckets[current].count = 0;
+
+			for (uint32_t i = 0; i < frontier.count; i++)
+			{
+				deltaEntry_t entry = frontier.data[i];
+
+				if (entry.distance != shared->distances[entry.index]) continue; /* found a shorter way since */
+
+				if (!shared->settled[entry.index]) /* remember it for the heavy edges */
+				{
+					shared->settled[entry.index] = true;
+					if (!appendDeltaEntry(&worker->settled, entry.index, entry.distance)) worker->failed = true;
+				}
+
+				relaxDeltaEdges(worker, entry.index, entry.distance, true);
+			}
+
+			worker->frontier = frontier;
+			worker->frontier.count = 0;
+
+			waitDeltaBarrier(shared);
+			applyDeltaRequests(worker, &lowest);
+			waitDeltaBarrier(shared);
+			clearDeltaRequests(worker);
+
+			shared->votes[worker->id] = worker->failed ? DELTA_FAILED : (0 != worker->buckets[current].count);
+			waitDeltaBarrier(shared);
+
+			bool active = false;
+			for (uint32_t i = 0; i < threads; i++)
+			{
+				if (DELTA_FAILED == shared->votes[i]) return NULL;
+				if (0 != shared->votes[i]) active = true;
+			}
+
+			if (!active) break;
+		}
+
+		/* the distances of the nodes in this bucket are final now, heavy edges only reach later buckets */
+		for (uint32_t i = 0; i < worker->settled.count; i++)
+		{
+			uint32_t index = worker->settled.data[i].index;
+
+			shared->settled[index] = false;
+			relaxDeltaEdges(worker, index, shared->distances[index], false);
+		}
+
+		waitDeltaBarrier(shared);
+		applyDeltaRequests(worker, &lowest);
+		waitDeltaBarrier(shared);
+		clearDeltaRequests(worker);
+	}
+}
+#endif
+
+bool deltaStepping(search_t *search)
+{   /* parallel label correcting search with the same result as dijkstra, node i belongs to thread i % threads */
+#if POSIX_AVAILABLE
+	const uint32_t count = search->graph->count;
+	const uint32_t threads = threadCount;
+
+	deltaShared_t shared;
+	shared.adjacency = search->adjacency;
+	shared.threads = threads;
+	shared.limit = search->limit;
+	shared.delta = chooseDelta(search->adjacency, search->limit);
+	shared.bucketCount = (uint32_t)(search->limit / shared.delta) + 1;
+	shared.distances = search->vertices.distances; /* (all INFINITY32 from createSearch) */
+	shared.settled = (bool*)calloc(count, sizeof(bool));
+	shared.requests = (deltaList_t*)calloc((size_t)threads * threads, sizeof(deltaList_t));
+	shared.votes = (uint32_t*)malloc(sizeof(uint32_t) * threads);
+	shared.waiting = shared.generation = 0;
+	shared.gate = DELTA_GATE_CLOSED;
+
+	deltaWorker_t *workers = (deltaWorker_t*)calloc(threads, sizeof(deltaWorker_t));
+
+	bool success = (NULL != shared.settled && NULL != shared.requests && NULL != shared.votes && NULL != workers);
+
+	for (uint32_t i = 0; success && i < threads; i++)
+	{
+		workers[i].shared = &shared;
+		workers[i].id = i;
+		workers[i].buckets = (deltaList_t*)calloc(shared.bucketCount, sizeof(deltaList_t));
+
+		success = (NULL != workers[i].buckets);
+	}
+
+	if (success)
+	{
+		shared.distances[search->startIndex] = 0;
+		success = appendDeltaEntry(&workers[search->startIndex % threads].buckets[0], search->startIndex, 0);
+	}
+
+	bool started = false;
+
+	if (success)
+	{
+		pthread_t handles[MAX_THREADS];
+		uint32_t running = 1;
+
+		pthread_mutex_init(&shared.mutex, NULL);
+		pthread_cond_init(&shared.condition, NULL);
+
+		while (running < threads && 0 == pthread_create(&handles[running], NULL, deltaWork, &workers[running])) running++;
+
+		started = (running == threads);
+
+		pthread_mutex_lock(&shared.mutex); /* let them all work or send them all home */
+		shared.gate = started ? DELTA_GATE_OPEN : DELTA_GATE_ABORT;
+		pthread_cond_broadcast(&shared.condition);
+		pthread_mutex_unlock(&shared.mutex);
+
+		if (started) deltaWork(&workers[0]);
+
+		for (uint32_t i = 1; i < running; i++) pthread_join(handles[i], NULL);
+
+		pthread_cond_destroy(&shared.condition);
+		pthread_mutex_destroy(&shared.mutex);
+
+		for (uint32_t i = 0; i < threads; i++) if (workers[i].failed) success = false;
+	}
+
+	if (success && started)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (INFINITY32 == shared.distances[i]) continue;
+
+			SET_BIT(search->vertices.visited, i);
+			SET_BIT(search->reached, i);
+		}
+	}
+
+	for (uint32_t i = 0; NULL != workers && i < threads; i++)
+	{
+		if (NULL != workers[i].buckets)
+		{
+			for (uint32_t j = 0; j < shared.bucketCount; j++) free(workers[i].buckets[j].data);
+		}
+
+		free(workers[i].buckets);
+		free(workers[i].frontier.data);
+		free(workers[i].settled.data);
+	}
+
+	for (size_t i = 0; NULL != shared.requests && i < (size_t)threads * threads; i++) free(shared.requests[i].data);
+
+	free(workers);
+	free(shared.requests);
+	free(shared.votes);
+	free(shared.settled);
+
+	if (success && !started) return dijkstra(search); /* not enough threads, do it alone */
+
+	return success;
+#else
+	return dijkstra(search); /* no threads */
+#endif
+}
+/*====DELTA-STEPPING ROUTINES==================================================*/
+
+
+/*====HIERARCHY ROUTINES=======================================================*/
+int buildHierarchy(graph_t *graph)
+{   /* contracts one node after the other, always the one with the lowest hierarchyPriority, with lazy updates. a contracted node
+	   keeps the edges it has left, those go to the nodes that come later: higher up. the last one gets position 0, so the sweep
+	   of phast goes through the arrays from the front to the back */
+	freeHierarchy(&graph->hierarchy);
+
+	uint32_t count = graph->count;
+
+	if (0 == count) return RESULT_OK;
+
+	contraction_t contraction;
+	heap_t queue; /* the nodes that are not contracted yet by priority */
+
+	contraction.out = (neighbourList_t*)calloc(count, sizeof(neighbourList_t));
+	contraction.in = (neighbourList_t*)calloc(count, sizeof(neighbourList_t));
+	contraction.deleted = (uint32_t*)calloc(count, sizeof(uint32_t));
+	contraction.witness.distances = (uint32_t*)malloc(sizeof(uint32_t) * count);
+	contraction.witness.visited = (uint64_t*)calloc(BITMAP_WORDS(count), sizeof(uint64_t)); /* (no targets) */
+	contraction.touched = (uint32_t*)malloc(sizeof(uint32_t) * count);
+	contraction.touchedCount = 0;
+	contraction.shortcuts = NULL;
+	contraction.shortcutCount = contraction.shortcutLimit = 0;
+	contraction.work = 0;
+
+	contraction.heap.count = queue.count = 0;
+	contraction.heap.limit = MEMORY_START_SIZE;
+	contraction.heap.data = (uint32_t*)malloc(sizeof(uint32_t) * MEMORY_START_SIZE);
+	contraction.heap.positions = (uint32_t*)malloc(sizeof(uint32_t) * count);
+	queue.limit = count;
+	queue.data = (uint32_t*)malloc(sizeof(uint32_t) * count);
+	queue.positions = (uint32_t*)malloc(sizeof(uint32_t) * count);
+
+	vertices_t priorities; /* the keys of queue are the distances, the visited bits are not used */
+	priorities.distances = (uint32_t*)malloc(sizeof(uint32_t) * count);
+	priorities.visited = NULL;
+	contraction.positions = (uint32_t*)malloc(sizeof(uint32_t) * count);
+	uint32_t *positions = contraction.positions;
+
+	int result = RESULT_MALLOC_ERR;
+	bool allocated = NULL != contraction.out && NULL != contraction.in && NULL != contraction.deleted && NULL != contraction.witness.distances &&
+		NULL != contraction.witness.visited && NULL != contraction.touched && NULL != contraction.heap.data && NULL != contraction.heap.positions &&
+		NULL != queue.data && NULL != queue.positions && NULL != priorities.distances && NULL != positions;
+
+	if (allocated)
+	{
+		memset(contraction.heap.positions, 0xFF, sizeof(uint32_t) * count); /* nothing is in the heaps */
+		memset(queue.positions, 0xFF, sizeof(uint32_t) * count);
+		memset(positions, 0xFF, sizeof(uint32_t) * count); /* nothing is contracted */
+		memset(contraction.witness.distances, 0xFF, sizeof(uint32_t) * count); /* INFINITY32 */
+
+		/* the edges of the graph without loops, parallel ones are only the shortest one */
+		for (uint32_t i = 0; i < count && allocated; i++)
+		{
+			for (uint32_t j = graph->out.offsets[i]; j < graph->out.offsets[i + 1] && allocated; j++)
+			{
+				neighbour_t *edge = &graph->out.neighbours[j];
+
+				if (i != edge->index && EDGE_REMOVED != edge->distance) allocated = addHierarchyEdge(&contraction, i, edge->index, edge->distance);
+			}
+		}
+	}
+
+	uint64_t workLimit = HIERARCHY_WORK_FACTOR * ((uint64_t)graph->out.count + count);
+
+	for (uint32_t i = 0; i < count && allocated && contraction.work <= workLimit; i++)
+	{
+		uint32_t shortcuts = findShortcuts(&contraction, i);
+
+		priorities.distances[i] = hierarchyPriority(&contraction, i, shortcuts);
+		allocated = (INFINITY32 != shortcuts) && insertNodeToHeap(&priorities, &queue, i);
+	}
+
+	uint64_t shortcutLimit = HIERARCHY_SHORTCUT_FACTOR * ((uint64_t)graph->out.count + count), shortcutCount = 0;
+	uint32_t position = count;
+
+	/* on a graph without much structure (random edges) the nodes that are left get more and more shortcuts between them, every
+	   contraction costs more than the one before and the searches would get nearly all of them anyway: give up early then */
+	while (allocated && shortcutCount <= shortcutLimit && contraction.work <= workLimit)
+	{
+		uint32_t node = removeMinNodeFromHeap(&priorities, &queue);
+
+		if (INFINITY32 == node) break; /* every node is contracted */
+
+		uint32_t shortcuts = findShortcuts(&contraction, node); /* the neighbourhood changed since the key was computed */
+
+		if (INFINITY32 == shortcuts) allocated = false;
+		else
+		{
+			priorities.distances[node] = hierarchyPriority(&contraction, node, shortcuts);
+
+			if (queue.count > 0 && priorities.distances[node] > priorities.distances[queue.data[0]])
+			{
+				allocated = insertNodeToHeap(&priorities, &queue, node); /* another one is cheaper now */
+				continue;
+			}
+
+			for (uint32_t i = 0; i < shortcuts && allocated; i++) /* the ones that were just found */
+			{
+				edge_t *shortcut = &contraction.shortcuts[i];
+				allocated = addHierarchyEdge(&contraction, shortcut->start, shortcut->end, (uint32_t)shortcut->distance);
+			}
+
+			shortcutCount += shortcuts;
+		}
+
+		if (!allocated) break;
+
+		/* the node keeps its edges (findShortcuts just dropped the ones to contracted nodes), the neighbours drop theirs later.
+		   (a hub can have half of the graph as neighbours, so removing them one by one would cost too much) */
+		neighbourList_t *out = &contraction.out[node], *in = &contraction.in[node];
+
+		for (uint32_t i = 0; i < out->count; i++) contraction.deleted[out->data[i].index]++;
+		for (uint32_t i = 0; i < in->count; i++) contraction.deleted[in->data[i].index]++;
+
+		positions[node] = --position;
+	}
+
+	if (allocated && (shortcutCount > shortcutLimit || contraction.work > workLimit)) result = RESULT_HIERARCHY_ERR;
+	else if (allocated)
+	{
+		hierarchy_t *hierarchy = &graph->hierarchy;
+
+		hierarchy->order = (uint32_t*)malloc(sizeof(uint32_t) * count);
+		hierarchy->up.offsets = (uint32_t*)calloc((size_t)count + 1, sizeof(uint32_t));
+		hierarchy->down.offsets = (uint32_t*)calloc((size_t)count + 1, sizeof(uint32_t));
+
+		if (NULL != hierarchy->order && NULL != hierarchy->up.offsets && NULL != hierarchy->down.offsets)
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				hierarchy->order[positions[i]] = i;
+				hierarchy->up.offsets[positions[i] + 1] = contraction.out[i].count;
+				hierarchy->down.offsets[positions[i] + 1] = contraction.in[i].count;
+			}
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				hierarchy->up.offsets[i + 1] += hierarchy->up.offsets[i];
+				hierarchy->down.offsets[i + 1] += hierarchy->down.offsets[i];
+			}
+
+			hierarchy->up.count = hierarchy->up.offsets[count];
+			hierarchy->down.count = hierarchy->down.offsets[count];
+			hierarchy->up.neighbours = (neighbour_t*)malloc(sizeof(neighbour_t) * (hierarchy->up.count > 0 ? hierarchy->up.count : 1));
+			hierarchy->down.neighbours = (neighbour_t*)malloc(sizeof(neighbour_t) * (hierarchy->down.count > 0 ? hierarchy->down.count : 1));
+		}
+
+		if (NULL != hierarchy->up.neighbours && NULL != hierarchy->down.neighbours)
+		{
+			for (uint32_t i = 0; i < count; i++) /* in the order of the positions, the neighbours become positions too */
+			{
+				neighbourList_t *out = &contraction.out[hierarchy->order[i]], *in = &contraction.in[hierarchy->order[i]];
+				neighbour_t *up = &hierarchy->up.neighbours[hierarchy->up.offsets[i]], *down = &hierarchy->down.neighbours[hierarchy->down.offsets[i]];
+
+				for (uint32_t j = 0; j < out->count; j++)
+				{
+					up[j].index = positions[out->data[j].index];
+					up[j].distance = out->data[j].distance;
+				}
+
+				for (uint32_t j = 0; j < in->count; j++)
+				{
+					down[j].index = positions[in->data[j].index];
+					down[j].distance = in->data[j].distance;
+				}
+			}
+
+			result = RESULT_OK;
+		}
+	}
+
+	if (RESULT_OK != result) freeHierarchy(&graph->hierarchy);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (NULL != contraction.out && NULL != contraction.out[i].data) free(contraction.out[i].data);
+		if (NULL != contraction.in && NULL != contraction.in[i].data) free(contraction.in[i].data);
+	}
+
+	free(contraction.out);
+	free(contraction.in);
+	free(contraction.deleted);
+	free(contraction.witness.distances);
+	free(contraction.witness.visited);
+	free(contraction.touched);
+	free(contraction.shortcuts);
+	free(contraction.heap.data);
+	free(contraction.heap.positions);
+	free(queue.data);
+	free(queue.positions);
+	free(priorities.distances);
+	free(contraction.positions);
+
+	return result;
+}
+
+uint32_t hierarchyPriority(contraction_t *contraction, const uint32_t node, const uint32_t shortcuts)
+{   /* the shortcuts minus the edges that go away (twice each), plus the neighbours that are gone allready, so the contraction
+	   spreads out. hubs come last, they are what most shortest ways go through. (the key has to fit into a distance, the few
+	   nodes that would not fit get the first or the last place) */
+	int64_t degree = (int64_t)contraction->in[node].count + contraction->out[node].count;
+	int64_t priority = (int64_t)HIERARCHY_PRIORITY_BIAS + 2 * (int64_t)shortcuts + contraction->deleted[node] - 2 * degree;
+
+	if (degree > HIERARCHY_HUB_DEGREE) priority += HIERARCHY_PRIORITY_BIAS >> 1;
+
+	return (priority < 0) ? 0 : (priority >= INFINITY32) ? INFINITY32 - 1 : (uint32_t)priority;
+}
+
+uint32_t findShortcuts(contraction_t *contraction, const uint32_t node)
+{   /* every way from -> node -> to needs a shortcut from -> to, unless a witness search finds one that is as short without node */
+	neighbourList_t *in = &contraction->in[node];
+	neighbourList_t *out = &contraction->out[node];
+	uint32_t *distances = contraction->witness.distances;
+	uint64_t *targets = contraction->witness.visited;
+
+	contraction->shortcutCount = 0;
+
+	dropContracted(contraction, in);
+	dropContracted(contraction, out);
+
+	contraction->work += (uint64_t)in->count * out->count;
+
+	for (uint32_t i = 0; i < in->count; i++)
+	{
+		uint32_t from = in->data[i].index;
+		uint64_t first = in->data[i].distance, longest = 0;
+
+		contraction->targets = 0;
+
+		for (uint32_t j = 0; j < out->count; j++) /* the search can stop when it has them all */
+		{
+			if (from == out->data[j].index || TEST_BIT(targets, out->data[j].index)) continue;
+
+			SET_BIT(targets, out->data[j].index);
+			contraction->targets++;
+			if (out->data[j].distance > longest) longest = out->data[j].distance;
+		}
+
+		if (0 == contraction->targets) continue;
+
+		uint64_t limit = (first + longest < MAX_ID) ? first + longest : MAX_ID - 1; /* (no query goes further) */
+		bool searched = witnessSearch(contraction, from, node, limit);
+
+		for (uint32_t j = 0; j < out->count; j++) CLEAR_BIT(targets, out->data[j].index);
+
+		if (!searched) return INFINITY32;
+
+		for (uint32_t j = 0; j < out->count; j++)
+		{
+			uint32_t to = out->data[j].index;
+			uint64_t distance = first + out->data[j].distance;
+
+			if (from == to || distance >= MAX_ID || distances[to] <= distance) continue; /* too long for every query or not needed */
+
+			if (contraction->shortcutCount == contraction->shortcutLimit)
+			{
+				uint32_t newLimit = (0 == contraction->shortcutLimit) ? MEMORY_START_SIZE : contraction->shortcutLimit << 1;
+				edge_t *temp = (edge_t*)realloc(contraction->shortcuts, sizeof(edge_t) * newLimit);
+
+				if (NULL == temp) return INFINITY32;
+
+				contraction->shortcuts = temp;
+				contraction->shortcutLimit = newLimit;
+			}
+
+			edge_t *shortcut = &contraction->shortcuts[contraction->shortcutCount++];
+			shortcut->start = from;
+			shortcut->end = to;
+			shortcut->distance = distance;
+		}
+	}
+
+	return contraction->shortcutCount;
+}
+
+bool witnessSearch(contraction_t *contraction, const uint32_t from, const uint32_t without, const uint64_t limit)
+{   /* dijkstra from from that does not go through without, stops when every target is settled or after HIERARCHY_WITNESS_SETTLED
+	   nodes. the distances stay in witness until the next search, they are never shorter than the real ones */
+	vertices_t *witness = &contraction->witness;
+	uint32_t *distances = witness->distances;
+	heap_t *heap = &contraction->heap;
+
+	for (uint32_t i = 0; i < contraction->touchedCount; i++) distances[contraction->touched[i]] = INFINITY32;
+
+	distances[from] = 0;
+	contraction->touched[0] = from;
+	contraction->touchedCount = 1;
+
+	if (!insertNodeToHeap(witness, heap, from)) return false;
+
+	for (uint32_t settled = 0; settled < HIERARCHY_WITNESS_SETTLED; settled++)
+	{
+		uint32_t index = removeMinNodeFromHeap(witness, heap);
+
+		if (INFINITY32 == index || (TEST_BIT(witness->visited, index) && 0 == --contraction->targets)) break; /* (the last target is final) */
+
+		uint32_t distance = distances[index];
+		neighbourList_t *edges = &contraction->out[index];
+
+		contraction->work += edges->count; /* (dropping the contracted ones costs as much as the rest) */
+
+		dropContracted(contraction, edges);
+
+		for (uint32_t i = 0; i < edges->count; i++)
+		{
+			uint32_t next = edges->data[i].index;
+			uint32_t newDistance = addDistance(distance, edges->data[i].distance);
+
+			if (without == next || newDistance > limit || newDistance >= distances[next]) continue;
+
+			if (INFINITY32 == distances[next]) contraction->touched[contraction->touchedCount++] = next;
+
+			distances[next] = newDistance;
+
+			if (!insertNodeToHeap(witness, heap, next)) return false;
+		}
+	}
+
+	while (heap->count > 0) heap->positions[heap->data[--heap->count]] = INFINITY32; /* the rest is not needed */
+
+	return true;
+}
+
+bool addHierarchyEdge(contraction_t *contraction, const uint32_t from, const uint32_t to, const uint32_t distance)
+{
+	neighbourList_t *out = &contraction->out[from];
+
+	contraction->work += out->count;
+
+	for (uint32_t i = 0; i < out->count; i++)
+	{
+		if (to != out->data[i].index) continue;
+
+		if (distance >= out->data[i].distance) return true;
+
+		out->data[i].distance = distance; /* the new one is shorter, it gets into in next to the old one (to can be a hub) */
+
+		return appendNeighbour(&contraction->in[to], from, distance);
+	}
+
+	return appendNeighbour(out, to, distance) && appendNeighbour(&contraction->in[to], from, distance);
+}
 
-	if (saveHouses->count == saveHouses->limit)
+bool appendNeighbour(neighbourList_t *list, const uint32_t index, const uint32_t distance)
+{
+	if (list->count == list->limit)
 	{
-		saveHouses->limit = saveHouses->limit << 1;
-
-		uint32_t *temp = (uint32_t*)malloc(sizeof(uint32_t) * saveHouses->limit);
+		uint32_t newLimit = (0 == list->limit) ? 4 : list->limit << 1; /* (most nodes have only a few) */
+		neighbour_t *temp = (neighbour_t*)realloc(list->data, sizeof(neighbour_t) * newLimit);
 
 		if (NULL == temp) return false;
 
-		memcpy(temp, saveHouses->data, sizeof(uint32_t) * saveHouses->count);
-		free(saveHouses->data);
-		saveHouses->data = temp;
+		list->data = temp;
+		list->limit = newLimit;
 	}
 
-	saveHouses->data[saveHouses->count] = id;
-	saveHouses->count++;
+	list->data[list->count].index = index;
+	list->data[list->count].distance = distance;
+	list->count++;
 
 	return true;
 }
 
-bool checkSaveHouse(savehouses_t *__restrict saveHouses, const uint32_t houseID)
-{   /* do a binsearch in the saveHouses */
-	return (NULL != bsearch(&houseID, saveHouses->data, saveHouses->count, sizeof(uint32_t), compare_saveHouses));
-}
-/*====SAVEHOUSE ROUTINES=======================================================*/
-
-
-/*====COMPARATOR ROUTINES======================================================*/
-int compare_edges(const void *e1, const void *e2)
+void dropContracted(contraction_t *__restrict contraction, neighbourList_t *__restrict list)
 {
-	if (((edge_t*)e1)->startID == ((edge_t*)e2)->startID) return 0;
-	else if (((edge_t*)e1)->startID < ((edge_t*)e2)->startID) return -1;
-	else return 1;
-}
+	uint32_t kept = 0;
 
-int compare_saveHouses(const void *e1, const void *e2)
-{
-	if (*((uint32_t*)e1) == *((uint32_t*)e2)) return 0;
-	else if (*((uint32_t*)e1) < *((uint32_t*)e2)) return -1;
-	else return 1;
-}
+	for (uint32_t i = 0; i < list->count; i++)
+	{
+		if (INFINITY32 == contraction->positions[list->data[i].index]) list->data[kept++] = list->data[i];
+	}
 
-int compare_nodes(const void *e1, const void *e2)
-{
-	if (((node_t*)e1)->id == ((node_t*)e2)->id) return 0;
-	else if (((node_t*)e1)->id < ((node_t*)e2)->id) return -1;
-	else return 1;
+	list->count = kept;
 }
-/*====COMPARATOR ROUTINES======================================================*/
 
+bool phast(search_t *search)
+{   /* dijkstra from the start only on the edges that go up, then one sweep over all positions from the top down: every node
+	   takes the shortest of its edges that come down to it, the nodes they start at are final by then. the search on in goes
+	   up the down edges and sweeps over the up ones. the result is the same as the one of dijkstra */
+	graph_t *graph = search->graph;
+	hierarchy_t *hierarchy = &graph->hierarchy;
+	const uint32_t count = graph->count;
+	const uint64_t limit = search->limit;
+	const bool forward = (&graph->out == search->adjacency);
+
+	uint32_t start = 0;
+	while (hierarchy->order[start] != search->startIndex) start++; /* (the position of every node is not kept, the sweep is linear anyway) */
+
+	search_t upward;
+	upward.graph = graph;
+	upward.adjacency = forward ? &hierarchy->up : &hierarchy->down;
+	upward.startIndex = start;
+	upward.limit = limit;
+	upward.vertices.distances = (uint32_t*)malloc(sizeof(uint32_t) * count); /* per position, the sweep goes on in them */
+	upward.vertices.visited = search->vertices.visited; /* borrowed like reached, the bits of the positions are cleared again */
+	upward.reached = search->reached;
+	upward.targets = NULL; /* (the sweep needs every node the upward search can reach) */
+	upward.targetCount = 0;
+
+	uint32_t *distances = upward.vertices.distances; /* (every node the search put into its queue is final, the others are INFINITY32) */
+
+	bool success = (NULL != distances);
+
+	if (success)
+	{
+		memset(distances, 0xFF, sizeof(uint32_t) * count);
 
-/*====GRAPH ROUTINES===========================================================*/
-bool buildGraph(savehouses_t *__restrict saveHouses, edges_t *__restrict edges, graph_t *__restrict graph)
-{
-	if (NULL == graph->vertices /*|| NULL == graph->mapping*/) return false;
+		success = dijkstra(&upward);
+	}
 
-	uint32_t currentID = INFINITY32;
-	for (size_t i = 0; i < edges->count; i++) /* convert all the edges to nodes */
+	if (success)
 	{
-		if (currentID == edges->data[i].startID) continue; /* filter duplicates (the same startid may occour multiple times because one node can have many neighbours) */
+		memset(search->vertices.visited, 0, sizeof(uint64_t) * BITMAP_WORDS(count));
+		memset(search->reached, 0, sizeof(uint64_t) * BITMAP_WORDS(count));
 
-		node_t nn; /* create a node */
-		nn.id = edges->data[i].startID; /* save id */
-		nn.isSaveHouse = checkSaveHouse(saveHouses, nn.id); /* check if it is a savehouse */
-		nn.visited = false;
-		nn.distance = INFINITY64; /* set distance from startID to INFINITY */
+		const adjacency_t *sweep = forward ? &hierarchy->down : &hierarchy->up;
+		const uint32_t *offsets = sweep->offsets;
+		const neighbour_t *neighbours = sweep->neighbours;
 
-		nn.neighbours = (neighbour_t*)calloc(SUB_NODE_START_SIZE, sizeof(neighbour_t)); /* allocate start memory for the neighbours */
-		nn.neighboursCount = 0;
-		nn.neighboursLimit = SUB_NODE_START_SIZE;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t best = distances[i];
+			uint32_t last = offsets[i + 1];
 
-		if (NULL == nn.neighbours) return false; /* check if that worked */
+			for (uint32_t j = offsets[i]; j < last; j++)
+			{
+				uint32_t distance = addDistance(distances[neighbours[j].index], neighbours[j].distance);
+				best = (distance < best) ? distance : best;
+			}
 
-		if (!insertNode(graph, nn)) /* insert this node into the list */
-		{
-			if (NULL != nn.neighbours)
+			if (best > limit)
 			{
-				free(nn.neighbours);
-				nn.neighbours = NULL;
+				distances[i] = INFINITY32;
+				continue;
 			}
 
-			return false;
-		}
+			uint32_t node = hierarchy->order[i];
 
-		currentID = edges->data[i].startID; /* update currentID (skip the next occurences of this id) */
-											/* this works because the edges are sorted, the same ids are right behind each other in chunks */
+			distances[i] = best;
+			search->vertices.distances[node] = best;
+			SET_BIT(search->vertices.visited, node);
+			SET_BIT(search->reached, node);
+		}
 	}
 
-	qsort(graph->vertices, graph->count, sizeof(node_t), compare_nodes); /* sort the nodes to enable binary search */
+	if (NULL != distances) free(distances);
+
+	return success;
+}
+/*====HIERARCHY ROUTINES=======================================================*/
+
 
-	if (INFINITY32 == findNode(graph, globalEndID)) /* check that we haven't missed the end node */
+/*====UPDATE ROUTINES==========================================================*/
+static inline neighbour_t *firstEdge(edgeCursor_t *cursor, adjacency_t *adjacency, const uint32_t index)
+{
+	cursor->adjacency = adjacency;
+	cursor->position = adjacency->offsets[index];
+	cursor->last = adjacency->offsets[index + 1];
+	cursor->added = (NULL != adjacency->addedHeads) ? adjacency->addedHeads[index] : INFINITY32;
+
+	return nextEdge(cursor);
+}
+
+static inline neighbour_t *nextEdge(edgeCursor_t *cursor)
+{
+	while (cursor->position < cursor->last)
 	{
-		node_t nn;
-		nn.distance = INFINITY64;
-		nn.id = globalEndID;
-		nn.isSaveHouse = checkSaveHouse(saveHouses, nn.id);
-		nn.neighbours = NULL;
-		nn.neighboursCount = 0;
-		nn.neighboursLimit = 0;
-		nn.visited = false;
+		neighbour_t *edge = &cursor->adjacency->neighbours[cursor->position++];
 
-		if (!insertNode(graph, nn)) return false;
+		if (EDGE_REMOVED != edge->distance) return edge;
+	}
 
-		/* find position where this node belongs */
-		for (size_t j = graph->count - 1; j > 0; j--)
-		{
-			if (graph->vertices[j].id < graph->vertices[j - 1].id)
-			{
-				node_t temp = graph->vertices[j];
-				graph->vertices[j] = graph->vertices[j - 1];
-				graph->vertices[j - 1] = temp;
-			}
-			else break;
-		}
+	while (INFINITY32 != cursor->added)
+	{
+		addedEdge_t *added = &cursor->adjacency->added[cursor->added];
+		cursor->added = added->next;
+
+		if (EDGE_REMOVED != added->edge.distance) return &added->edge;
 	}
 
-	for (size_t i = 0; i < graph->count; i++) /* go through all nodes and set its neighbours */
+	return NULL;
+}
+
+uint32_t shortestEdge(adjacency_t *adjacency, const uint32_t from, const uint32_t to)
+{
+	uint32_t shortest = EDGE_REMOVED;
+	edgeCursor_t cursor;
+
+	for (neighbour_t *edge = firstEdge(&cursor, adjacency, from); NULL != edge; edge = nextEdge(&cursor))
 	{
-		/* find the first index where this id occurs (since the array is sorted all the elements with the
-		same id are in a block, so by finding the first of that block we can iterate through all of them) */
-		uint32_t index = findFirstEdge(edges, graph->vertices[i].id);
+		if (to == edge->index && edge->distance < shortest) shortest = edge->distance;
+	}
 
-		if (INFINITY32 != index)
-		{
-			currentID = graph->vertices[i].id; /* this is the id we currently want to find */
+	return shortest;
+}
 
-											   /* just work through all the items in the block explained above
-											   (keep going until we enter the next block) */
-			while (index < edges->count && edges->data[index].startID == currentID)
-			{
-				uint32_t nodeIndex = findNode(graph, edges->data[index].endID); /* find the node with the endID */
-			
-				if (INFINITY32 != nodeIndex) /* nodeIndex == INFINITY32 means that the corresponding node hat no outgoing edges and is therefore useless */
-					if (!insertChildNode(&(graph->vertices[i]), nodeIndex, edges->data[index].distance))
-						return false; /* and try to insert the index into the parent node */
+uint32_t changeEdges(adjacency_t *adjacency, const uint32_t from, const uint32_t to, const uint32_t weight)
+{   /* parallel edges all get the same weight (or are all removed), the shortest one before is what the repair needs */
+	uint32_t shortest = EDGE_REMOVED;
+	edgeCursor_t cursor;
 
-				index++;
-			}
-		}
+	for (neighbour_t *edge = firstEdge(&cursor, adjacency, from); NULL != edge; edge = nextEdge(&cursor))
+	{
+		if (to != edge->index) continue;
 
-		if (0 == graph->vertices[i].neighboursCount)
-		{
-			free(graph->vertices[i].neighbours);
-			graph->vertices[i].neighbours = NULL;
-			graph->vertices[i].neighboursCount = 0;
-			graph->vertices[i].neighboursLimit = 0;
-		}
+		if (edge->distance < shortest) shortest = edge->distance;
+
+		edge->distance = weight;
 	}
 
-	return true;
+	return shortest;
 }
 
-bool insertChildNode(node_t *__restrict parent, const uint32_t indexOfChild, const uint64_t distanceToChild)
-{
-	if (parent->neighboursCount == parent->neighboursLimit) /* check if there is space left */
+bool insertAddedEdge(graph_t *graph, const uint32_t from, const uint32_t to, const uint32_t weight)
+{   /* a removed edge of the same node makes room in the block, otherwise the edge goes into the list of its node */
+	uint32_t outSlot = INFINITY32, inSlot = INFINITY32;
+
+	for (uint32_t i = graph->out.offsets[from]; i < graph->out.offsets[from + 1] && INFINITY32 == outSlot; i++)
 	{
-		parent->neighboursLimit += SUB_NODE_START_SIZE; /* if no, increase memory  */
+		if (EDGE_REMOVED == graph->out.neighbours[i].distance) outSlot = i;
+	}
 
-		neighbour_t *temp = (neighbour_t*)calloc(parent->neighboursLimit, sizeof(neighbour_t)); /* allocate more */
+	for (uint32_t i = graph->in.offsets[to]; i < graph->in.offsets[to + 1] && INFINITY32 == inSlot; i++)
+	{
+		if (EDGE_REMOVED == graph->in.neighbours[i].distance) inSlot = i;
+	}
 
-		if (NULL == temp) return false; /* check if it worked */
+	if (INFINITY32 != outSlot && INFINITY32 != inSlot)
+	{
+		graph->out.neighbours[outSlot].index = to;
+		graph->out.neighbours[outSlot].distance = weight;
+		graph->in.neighbours[inSlot].index = from;
+		graph->in.neighbours[inSlot].distance = weight;
 
-		memcpy(temp, parent->neighbours, sizeof(neighbour_t) * parent->neighboursCount); /* copy the content and free old data */
-		free(parent->neighbours);
-		parent->neighbours = temp;
+		return true;
 	}
 
-	neighbour_t nb; /* create new neighbour */
-	nb.index = indexOfChild;
-	nb.distance = distanceToChild;
-	parent->neighbours[parent->neighboursCount] = nb; /* put it in the list */
-	parent->neighboursCount++; /* count up */
+	if (!reserveAddedEdge(&graph->out, graph->count) || !reserveAddedEdge(&graph->in, graph->count)) return false; /* (both or none) */
+
+	adjacency_t *adjacencies[2] = { &graph->out, &graph->in };
+	uint32_t tails[2] = { from, to }, heads[2] = { to, from };
+
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		adjacency_t *adjacency = adjacencies[i];
+		addedEdge_t *added = &adjacency->added[adjacency->addedCount];
+
+		added->edge.index = heads[i];
+		added->edge.distance = weight;
+		added->next = adjacency->addedHeads[tails[i]];
+		adjacency->addedHeads[tails[i]] = adjacency->addedCount++;
+	}
 
 	return true;
 }
 
-bool insertNode(graph_t *__restrict graph, node_t node)
+bool reserveAddedEdge(adjacency_t *adjacency, const uint32_t count)
 {
-	if (graph->count == graph->limit) /* check if the memory limit is reached */
+	if (NULL == adjacency->addedHeads)
 	{
-		graph->limit = graph->limit << 1; /* if => increase size */
-
-		node_t *temp = (node_t*)calloc(graph->limit, sizeof(node_t)); /* get more memory */
+		adjacency->addedHeads = (uint32_t*)malloc(sizeof(uint32_t) * (count > 0 ? count : 1));
 
-		if (NULL == temp) return false; /* check if this worked */
+		if (NULL == adjacency->addedHeads) return false;
 
-		memcpy(temp, graph->vertices, sizeof(node_t) * graph->count); /* copy data to new memory */
-		free(graph->vertices); /* free old data */
-		graph->vertices = temp; /* adjust */
+		memset(adjacency->addedHeads, 0xFF, sizeof(uint32_t) * count); /* no node has an added edge (INFINITY32) */
 	}
 
-	graph->vertices[graph->count] = node; /* insert item */
-	graph->count++; /* increment counter */
+	if (adjacency->addedCount == adjacency->addedLimit)
+	{
+		uint32_t limit = (0 == adjacency->addedLimit) ? MEMORY_START_SIZE : adjacency->addedLimit << 1;
+		addedEdge_t *temp = (addedEdge_t*)realloc(adjacency->added, sizeof(addedEdge_t) * limit);
+
+		if (NULL == temp) return false;
+
+		adjacency->added = temp;
+		adjacency->addedLimit = limit;
+	}
 
 	return true;
 }
 
-uint32_t findNode(graph_t *__restrict graph, const uint32_t id)
-{   /* TODO: make this efficient (dont ic it is yet); this function is executed >50% of runtime */
-	if (0 == graph->count) return INFINITY32; /* if there are no entries its not there */
+bool mergeAddedEdges(graph_t *graph)
+{   /* the node indices stay the same, so the searches of a watched query stay valid */
+	if (NULL != graph->snapshot && !detachSnapshot(graph)) return false;
+
+	return mergeAdjacency(&graph->out, graph->count) && mergeAdjacency(&graph->in, graph->count);
+}
 
-	if (graph->vertices[0].id == id) return 0; /* check borders because they are slow to reach with binsearch */
-	if (graph->vertices[graph->count - 1].id == id) return graph->count - 1;
+bool mergeAdjacency(adjacency_t *adjacency, const uint32_t count)
+{   /* new blocks with the added edges after the old ones, removed edges are left out (counted first, then copied) */
+	uint32_t *offsets = (uint32_t*)malloc(sizeof(uint32_t) * ((size_t)count + 1));
 
-	uint32_t left = 0, right = graph->count, middle = 0; /* perform a binsearch to find the id */
+	if (NULL == offsets) return false;
 
-	while (left <= right && right <= graph->count)
+	edgeCursor_t cursor;
+	offsets[0] = 0;
+
+	for (uint32_t i = 0; i < count; i++)
 	{
-		middle = left + ((right - left) >> 1);
-		if (id < graph->vertices[middle].id) right = middle - 1;
-		else if (id > graph->vertices[middle].id) left = middle + 1;
-		else return middle;
+		offsets[i + 1] = offsets[i];
+
+		for (neighbour_t *edge = firstEdge(&cursor, adjacency, i); NULL != edge; edge = nextEdge(&cursor)) offsets[i + 1]++;
 	}
 
-	return INFINITY32;
+	neighbour_t *neighbours = (neighbour_t*)malloc(sizeof(neighbour_t) * (offsets[count] > 0 ? offsets[count] : 1));
+
+	if (NULL == neighbours)
+	{
+		free(offsets);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		neighbour_t *target = &neighbours[offsets[i]];
+
+		for (neighbour_t *edge = firstEdge(&cursor, adjacency, i); NULL != edge; edge = nextEdge(&cursor)) *target++ = *edge;
+	}
+
+	free(adjacency->offsets);
+	free(adjacency->neighbours);
+	if (NULL != adjacency->addedHeads) free(adjacency->addedHeads);
+	if (NULL != adjacency->added) free(adjacency->added);
+
+	adjacency->offsets = offsets;
+	adjacency->neighbours = neighbours;
+	adjacency->count = offsets[count];
+	adjacency->addedHeads = NULL;
+	adjacency->added = NULL;
+	adjacency->addedCount = adjacency->addedLimit = 0;
+
+	return true;
 }
-/*====GRAPH ROUTINES===========================================================*/
 
+bool updateSaveHouse(graph_t *graph, const uint32_t id, const bool add)
+{   /* a node only gets its bit changed, an id without a node is added to or removed from the sorted list */
+	uint32_t index = findNode(graph, id);
 
-/*====HEAP ROUTINES============================================================*/
-bool insertNodeToHeap(graph_t *__restrict graph, heap_t *__restrict heap, const uint32_t element)
-{
-	if (INFINITY32 != heap->positions[element]) /* check if the element is in the heap allready */
+	if (INFINITY32 != index)
 	{
-		siftUpHeap(graph, heap, heap->positions[element]); /* if yes just update the position */
+		if (add) SET_BIT(graph->saveHouseBits, index);
+		else CLEAR_BIT(graph->saveHouseBits, index);
 
 		return true;
 	}
 
-	if (heap->count == heap->limit) /* if the memory limit is reached */
+	savehouses_t *saveHouses = &graph->saveHouses;
+	uint32_t left = 0, right = saveHouses->count;
+
+	while (left < right) /* where it is or would be */
 	{
-		heap->limit = heap->limit << 1; /* increase memory limit */
+		uint32_t middle = left + ((right - left) >> 1);
+		if (saveHouses->data[middle] < id) left = middle + 1;
+		else right = middle;
+	}
 
-		uint32_t *temp = (uint32_t*)calloc(heap->limit, sizeof(uint32_t)); /* get new memory in bigger size */
+	bool found = (left < saveHouses->count && saveHouses->data[left] == id);
 
-		if (NULL == temp) return false; /* check if that worked */
+	if (add == found) return true; /* nothing to do */
 
-		memcpy(temp, heap->data, sizeof(uint32_t) * heap->count); /* copy the data to the new array */
-		free(heap->data); /* delete the old array */
-		heap->data = temp; /* adjust the pointers */
-	}
+	if (NULL != graph->snapshot && !detachSnapshot(graph)) return false; /* the list in the snapshot can not grow */
 
-	heap->positions[element] = heap->count;
-	heap->data[heap->count] = element; /* set the last item to the new element */
-	siftUpHeap(graph, heap, heap->count); /* sift-up the element */
+	if (add)
+	{
+		if (!insertSaveHouse(saveHouses, id)) return false; /* makes room at the end */
 
-	heap->count++; /* increment the count of elements */
+		memmove(&saveHouses->data[left + 1], &saveHouses->data[left], sizeof(uint32_t) * (saveHouses->count - 1 - left));
+		saveHouses->data[left] = id;
+	}
+	else
+	{
+		memmove(&saveHouses->data[left], &saveHouses->data[left + 1], sizeof(uint32_t) * (saveHouses->count - 1 - left));
+		saveHouses->count--;
+	}
 
 	return true;
 }
+/*====UPDATE ROUTINES==========================================================*/
 
-uint32_t removeMinNodeFromHeap(graph_t *__restrict graph, heap_t *__restrict heap)
-{
-	if (0 == heap->count) return INFINITY32;
 
-	uint32_t result = heap->data[0]; /* remove first item (the smallest) */
+/*====REPAIR ROUTINES==========================================================*/
+int startWatch(graph_t *__restrict graph, watch_t *__restrict watch, const uint32_t startID, const uint32_t endID, const uint64_t limit)
+{   /* the two searches of findSaveHouses, but they are kept with everything a repair needs */
+	freeWatch(watch);
 
-	heap->count--;
+	uint32_t startIndex = findNode(graph, startID);
+	uint32_t endIndex = findNode(graph, endID);
 
-	heap->data[0] = heap->data[heap->count]; /* set new root to the very last element (also decrement size) */
-	heap->positions[heap->data[0]] = 0; /* mark position as free */
-	siftDownHeap(graph, heap, 0); /* restore the heap properties starting from the new root  and update position */
+	if (INFINITY32 == startIndex || INFINITY32 == endIndex) return RESULT_INPUT_ERR; /* updates can not add nodes */
 
-	heap->positions[result] = INFINITY32; /* mark returned item as deleted */
+	if (0 != graph->out.addedCount && !mergeAddedEdges(graph)) return RESULT_MALLOC_ERR; /* the searches only look at the blocks */
 
-	return result; /* return the value */
-}
+	bool created = createSearch(&watch->searches[0], graph, &graph->out, startIndex, limit);
+	created = createSearch(&watch->searches[1], graph, &graph->in, endIndex, limit) && created;
+	created = createQueue(&watch->queues[0], graph->count, limit) && created;
+	created = createQueue(&watch->queues[1], graph->count, limit) && created;
 
-void siftDownHeap(graph_t *__restrict graph, heap_t *__restrict heap, uint32_t index)
-{
-	// uint32_t localIndex = index;
-	uint32_t minimum = index; /* assume the root is the biggest */
-	while (true)
+	watch->marks = (uint8_t*)calloc(graph->count, sizeof(uint8_t)); /* all REPAIR_UNSEEN */
+	watch->seen = (uint32_t*)malloc(sizeof(uint32_t) * graph->count);
+	watch->answer = (uint64_t*)malloc(sizeof(uint64_t) * BITMAP_WORDS(graph->count));
+
+	created = created && NULL != watch->marks && NULL != watch->seen && NULL != watch->answer;
+
+	if (created) runSearchPair(watch->searches);
+
+	if (!created || !watch->searches[0].success || !watch->searches[1].success)
 	{
-		register uint32_t left = LEFT(index);
-		if (left < heap->count) /* compare with left child */
-		{
-			if (graph->vertices[heap->data[left]].distance < graph->vertices[heap->data[minimum]].distance)
-				minimum = left;
+		freeWatch(watch);
+		return RESULT_MALLOC_ERR;
+	}
 
-			register uint32_t right = RIGHT(index);
-			/* if the left children does not exists the right children can not exist */
-			if (right < heap->count && graph->vertices[heap->data[right]].distance < graph->vertices[heap->data[minimum]].distance) /* compare with right child */
-				minimum = right;
-		}
+	watch->active = true;
+	watch->touched = 0;
 
-		if (minimum == index) return;
+	return RESULT_OK;
+}
 
-		/* if the assumetion was wrong */
-		register uint32_t t = heap->data[index]; /* just swap the parent with the smaller child */
-		heap->data[index] = heap->data[minimum];
-		heap->data[minimum] = t;
+int answerWatch(graph_t *__restrict graph, watch_t *__restrict watch, savehouses_t *__restrict result)
+{   /* the same intersection as in findSaveHouses, but on a copy (the reached bits are kept) */
+	size_t words = BITMAP_WORDS(graph->count);
 
-		t = heap->positions[heap->data[index]];
-		heap->positions[heap->data[index]] = heap->positions[heap->data[minimum]];
-		heap->positions[heap->data[minimum]] = t;
+	memcpy(watch->answer, watch->searches[0].reached, sizeof(uint64_t) * words);
 
-		index = minimum; /* go one layer down */
-	}
+	uint64_t found = andBitmaps(watch->answer, watch->searches[1].reached, graph->saveHouseBits, words);
+
+	return listSaveHouses(graph, watch->answer, found, result);
 }
 
-void siftUpHeap(graph_t *__restrict graph, heap_t *__restrict heap, uint32_t index)
-{
-	while (true)
+int updateEdges(graph_t *__restrict graph, watch_t *__restrict watch, const uint32_t type, const uint32_t from, const uint32_t to, const uint32_t weight)
+{   /* changes the edges from -> to in both directions, then repairs both searches of the watched query. only the shortest of
+	   the parallel edges matters to a search, so it is enough to know that one before and after */
+	uint32_t before, after;
+
+	freeHierarchy(&graph->hierarchy); /* its shortcuts would be wrong now, the searches are plain dijkstra from here on */
+
+	if (UPDATE_REMOVE_EDGE != type && weight != graph->hopWeight) graph->hopWeight = WEIGHTS_MIXED; /* no more counting hops */
+
+	if (UPDATE_ADD_EDGE == type)
 	{
-		if (0 == index) return; /* abort when we reach the root */
+		before = shortestEdge(&graph->out, from, to);
+		after = (weight < before) ? weight : before;
 
-		register uint32_t parent = PARENT(index);
+		if (!insertAddedEdge(graph, from, to, weight)) return RESULT_MALLOC_ERR;
+	}
+	else
+	{
+		before = changeEdges(&graph->out, from, to, weight);
+		changeEdges(&graph->in, to, from, weight);
+		after = weight; /* (EDGE_REMOVED for UPDATE_REMOVE_EDGE) */
 
-		if (graph->vertices[heap->data[index]].distance >= graph->vertices[heap->data[parent]].distance) return; /* abort when we reached our final position */
+		if (EDGE_REMOVED == before) return RESULT_INPUT_ERR; /* there was no such edge */
+	}
 
-		register uint32_t t = heap->data[index]; /* swap the node with its parent */
-		heap->data[index] = heap->data[parent];
-		heap->data[parent] = t;
+	if (!watch->active) return RESULT_OK;
 
-		t = heap->positions[heap->data[index]]; /* also swap the positions they are registered in */
-		heap->positions[heap->data[index]] = heap->positions[heap->data[parent]];
-		heap->positions[heap->data[parent]] = t;
+	watch->touched = 0;
 
-		index = parent; /* go one layer up */
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		uint32_t tail = (0 == i) ? from : to; /* the search on in goes through the edge backwards */
+		uint32_t head = (0 == i) ? to : from;
+		bool repaired = true;
+
+		if (after < before) repaired = repairShorter(watch, i, tail, head, after);
+		else if (after > before) repaired = repairLonger(watch, i, tail, head, before);
+
+		if (!repaired) /* the distances are not right anymore */
+		{
+			freeWatch(watch);
+			return RESULT_MALLOC_ERR;
+		}
 	}
+
+	return RESULT_OK;
 }
-/*====HEAP ROUTINES============================================================*/
 
+bool repairShorter(watch_t *watch, const uint32_t which, const uint32_t tail, const uint32_t head, const uint32_t weight)
+{   /* only nodes that get shorter are touched: the head if the edge is a shorter way to it, then whatever it gets shorter for */
+	search_t *search = &watch->searches[which];
+	queue_t *queue = &watch->queues[which];
+	vertices_t *vertices = &search->vertices;
+	uint32_t distance = addDistance(vertices->distances[tail], weight); /* (INFINITY32 if the tail is not reached) */
 
-/*====DIJKSTRA ROUTINE=========================================================*/
-bool dijkstra(graph_t *__restrict graph, const uint32_t startIndex)
-{
-	heap_t heap; /* create new heap for dijkstra */
-	heap.count = 0;
-	heap.limit = graph->count / 2; /* TODO: find good start size */
-	if (heap.limit == 0) heap.limit = 2;
-	heap.data = (uint32_t*)calloc(heap.limit, sizeof(uint32_t));
+	if (distance > search->limit || distance >= vertices->distances[head]) return true; /* the edge is not used */
+
+	restartQueue(queue);
+
+	return lowerDistance(vertices, queue, head, distance) && propagateRepair(search, queue, &watch->touched);
+}
 
-	heap.positions = (uint32_t*)malloc(graph->count * sizeof(uint32_t)); /* positions saves the index in the heap array of each possible item */
+bool repairLonger(watch_t *watch, const uint32_t which, const uint32_t tail, const uint32_t head, const uint32_t weight)
+{   /* like ramalingam and reps: first find the nodes whose every shortest way went through the edge (in the order of their
+	   old distance, a node keeps its distance if a closer node that keeps its own is its predecessor on a shortest way),
+	   then only those are searched again, starting from their predecessors that kept their distance */
+	search_t *search = &watch->searches[which];
+	queue_t *queue = &watch->queues[which];
+	vertices_t *vertices = &search->vertices;
+	uint32_t *distances = vertices->distances;
+	adjacency_t *backward = (search->adjacency == &search->graph->out) ? &search->graph->in : &search->graph->out;
+	uint8_t *marks = watch->marks;
+	uint32_t seen = 0, index;
+	edgeCursor_t cursor;
 
-	if (NULL == heap.positions || NULL == heap.data) return false; /* check if the allocations worked */
+	/* if the old edge was not on a shortest way to the head nothing changes */
+	if (INFINITY32 == distances[tail] || addDistance(distances[tail], weight) != distances[head] || head == search->startIndex) return true;
 
-	memset(heap.positions, INFINITY32, graph->count * sizeof(uint32_t)); /* initalize the positions-array to all be infinity (not in heap) */
+	restartQueue(queue);
 
-	graph->vertices[startIndex].distance = 0; /* the startnode can reach its self in no time */
+	marks[head] = REPAIR_SEEN;
+	watch->seen[seen++] = head;
+	CLEAR_BIT(vertices->visited, head); /* (nodes in the queue are not visited) */
 
-	if (!insertNodeToHeap(graph, &heap, startIndex)) /* insert the startnode into the heap */
+	if (!insertNodeToQueue(vertices, queue, head, INFINITY32)) return false;
+
+	while (INFINITY32 != (index = removeMinNodeFromQueue(vertices, queue)))
 	{
-		if (NULL != heap.data) free(heap.data);  		/* free heap if neccessary */
-		if (NULL != heap.positions) free(heap.positions);
+		SET_BIT(vertices->visited, index);
 
-		return false;
+		uint32_t distance = distances[index];
+		bool kept = (index == search->startIndex);
+
+		for (neighbour_t *edge = firstEdge(&cursor, backward, index); !kept && NULL != edge; edge = nextEdge(&cursor))
+		{
+			uint32_t before = distances[edge->index]; /* closer ones are decided allready */
+
+			kept = (before < distance && REPAIR_AFFECTED != marks[edge->index] && addDistance(before, edge->distance) == distance);
+		}
+
+		if (kept) continue;
+
+		marks[index] = REPAIR_AFFECTED;
+
+		for (neighbour_t *edge = firstEdge(&cursor, search->adjacency, index); NULL != edge; edge = nextEdge(&cursor))
+		{
+			uint32_t child = edge->index;
+
+			if (REPAIR_UNSEEN == marks[child] && addDistance(distance, edge->distance) == distances[child] && INFINITY32 != distances[child])
+			{
+				marks[child] = REPAIR_SEEN;
+				watch->seen[seen++] = child;
+				CLEAR_BIT(vertices->visited, child);
+
+				if (!insertNodeToQueue(vertices, queue, child, INFINITY32)) return false;
+			}
+		}
 	}
 
-	while (heap.count > 0) /* while there are unprocessed nodes we continue */
+	if (queue->radix.failed) return false;
+
+	/* the affected nodes forget their distance, then each one gets the best way over a predecessor that kept its own */
+	for (uint32_t i = 0; i < seen; i++)
 	{
-		register uint32_t index = removeMinNodeFromHeap(graph, &heap); /* get the next node */
+		uint32_t node = watch->seen[i];
 
-		if (index == INFINITY32) break; /* return on error */
+		if (REPAIR_AFFECTED != marks[node]) continue;
 
-		neighbour_t *neighbours = graph->vertices[index].neighbours; /* get the neighbours from that node */
-		graph->vertices[index].visited = true; /* mark it as visited */
+		distances[node] = INFINITY32;
+		CLEAR_BIT(vertices->visited, node);
+		CLEAR_BIT(search->reached, node);
+	}
+
+	restartQueue(queue);
+
+	for (uint32_t i = 0; i < seen; i++)
+	{
+		uint32_t node = watch->seen[i];
 
-		for (register size_t neighbourIndex = 0; neighbourIndex < graph->vertices[index].neighboursCount; neighbourIndex++) /* and update distance to all its neighbours */
+		if (REPAIR_AFFECTED != marks[node]) continue;
+
+		for (neighbour_t *edge = firstEdge(&cursor, backward, node); NULL != edge; edge = nextEdge(&cursor))
 		{
-			uint32_t childIndex = neighbours[neighbourIndex].index;
-			uint64_t newDistance = graph->vertices[index].distance + neighbours[neighbourIndex].distance; /* calculate new distance */
+			if (REPAIR_AFFECTED == marks[edge->index]) continue;
 
-			if (!graph->vertices[childIndex].visited && newDistance <= graph->vertices[childIndex].distance) /* check if distance needs to be updated */
-			{
-				graph->vertices[childIndex].distance = newDistance; /* update if neccessary */
+			uint32_t distance = addDistance(distances[edge->index], edge->distance); /* (INFINITY32 is never within the limit) */
 
-				if (!insertNodeToHeap(graph, &heap, childIndex)) /* put the unseen neighbours into the heap */
-				{
-					if (NULL != heap.data) free(heap.data); /* free heap if neccessary */
-					if (NULL != heap.positions) free(heap.positions);
+			if (distance <= search->limit && distance < distances[node]) distances[node] = distance;
+		}
 
-					return false;
-				}
-			}
+		if (INFINITY32 != distances[node] && !insertNodeToQueue(vertices, queue, node, INFINITY32)) return false;
+	}
+
+	for (uint32_t i = 0; i < seen; i++) marks[watch->seen[i]] = REPAIR_UNSEEN; /* ready for the next update */
+
+	watch->touched += seen;
+
+	return propagateRepair(search, queue, &watch->touched);
+}
+
+bool propagateRepair(search_t *__restrict search, queue_t *__restrict queue, uint32_t *__restrict touched)
+{   /* dijkstra from the nodes in the queue, unlike in dijkstra() visited nodes can get shorter again */
+	vertices_t *vertices = &search->vertices;
+	uint32_t index;
+	edgeCursor_t cursor;
+
+	while (INFINITY32 != (index = removeMinNodeFromQueue(vertices, queue)))
+	{
+		SET_BIT(vertices->visited, index);
+		SET_BIT(search->reached, index);
+		(*touched)++;
+
+		for (neighbour_t *edge = firstEdge(&cursor, search->adjacency, index); NULL != edge; edge = nextEdge(&cursor))
+		{
+			uint32_t distance = addDistance(vertices->distances[index], edge->distance);
+
+			if (distance <= search->limit && distance < vertices->distances[edge->index] && !lowerDistance(vertices, queue, edge->index, distance)) return false;
 		}
 	}
 
-	if (NULL != heap.data) free(heap.data); /* free heap if neccessary */
-	if (NULL != heap.positions) free(heap.positions);
+	return !queue->radix.failed;
+}
 
-	return true;
+static inline bool lowerDistance(vertices_t *__restrict vertices, queue_t *__restrict queue, const uint32_t index, const uint32_t distance)
+{
+	uint32_t oldDistance = TEST_BIT(vertices->visited, index) ? INFINITY32 : vertices->distances[index]; /* a visited node is not in the queue */
+
+	vertices->distances[index] = distance;
+	CLEAR_BIT(vertices->visited, index);
+
+	return insertNodeToQueue(vertices, queue, index, oldDistance);
 }
-/*====DIJKSTRA ROUTINE=========================================================*/
+
+void restartQueue(queue_t *queue)
+{   /* the radix heap only takes keys >= the last one it gave out, the others start over by themselves */
+	queue->radix.last = 0;
+}
+/*====REPAIR ROUTINES==========================================================*/
+
 
 
 /*====FREE ROUTINES============================================================*/
@@ -939,21 +5876,78 @@ void freeGraph(graph_t *graph)
 {
 	if (NULL == graph) return; /* check that pointer is valid */
 
-	for (size_t i = 0; i < graph->count; i++) /* interate through all the nodes of the graph */
+	if (NULL != graph->snapshot) /* every block is part of the snapshot, so there is just that one */
 	{
-		if (NULL != graph->vertices[i].neighbours) /* check for valid neighbour collections */
-		{
-			free(graph->vertices[i].neighbours); /* free neighbours of each node */
-			graph->vertices[i].neighbours = NULL; /* indicate that is free */
-			graph->vertices[i].neighboursCount = 0; /* update meta data */
-			graph->vertices[i].neighboursLimit = 0;
-		}
+#if POSIX_AVAILABLE
+		munmap(graph->snapshot, graph->snapshotSize);
+#else
+		free(graph->snapshot);
+#endif
+	}
+	else
+	{
+		if (NULL != graph->ids) free(graph->ids); /* delete every block of the graph */
+		if (NULL != graph->saveHouseBits) free(graph->saveHouseBits);
+		if (NULL != graph->out.offsets) free(graph->out.offsets);
+		if (NULL != graph->out.neighbours) free(graph->out.neighbours);
+		if (NULL != graph->in.offsets) free(graph->in.offsets);
+		if (NULL != graph->in.neighbours) free(graph->in.neighbours);
+		freeSaveHouses(&graph->saveHouses);
 	}
 
-	if (NULL != graph->vertices) free(graph->vertices); /* delete the nodes itself */
-	graph->vertices = NULL; /* mark it as freed */
+	freeHierarchy(&graph->hierarchy); /* (only if it was built after loading the snapshot) */
+
+	if (NULL != graph->out.addedHeads) free(graph->out.addedHeads); /* added edges are never in the snapshot */
+	if (NULL != graph->out.added) free(graph->out.added);
+	if (NULL != graph->in.addedHeads) free(graph->in.addedHeads);
+	if (NULL != graph->in.added) free(graph->in.added);
+	freePacked(&graph->out); /* (--compress) */
+	freePacked(&graph->in);
+	freePager(&graph->out); /* (--external) */
+	freePager(&graph->in);
+
+	graph->ids = NULL; /* mark it as freed */
+	graph->saveHouseBits = NULL;
+	graph->saveHouses.data = NULL;
+	graph->saveHouses.count = graph->saveHouses.limit = 0;
+	graph->out.offsets = graph->in.offsets = NULL;
+	graph->out.neighbours = graph->in.neighbours = NULL;
 	graph->count = 0; /* meta data */
-	graph->limit = 0;
+	graph->out.count = graph->in.count = 0;
+	graph->out.addedHeads = graph->in.addedHeads = NULL;
+	graph->out.added = graph->in.added = NULL;
+	graph->out.addedCount = graph->in.addedCount = 0;
+	graph->out.addedLimit = graph->in.addedLimit = 0;
+	graph->snapshot = NULL;
+	graph->snapshotSize = 0;
+}
+
+void freeHierarchy(hierarchy_t *hierarchy)
+{
+	if (!hierarchy->mapped) /* a mapped one goes with the snapshot */
+	{
+		if (NULL != hierarchy->order) free(hierarchy->order);
+		if (NULL != hierarchy->up.offsets) free(hierarchy->up.offsets);
+		if (NULL != hierarchy->up.neighbours) free(hierarchy->up.neighbours);
+		if (NULL != hierarchy->down.offsets) free(hierarchy->down.offsets);
+		if (NULL != hierarchy->down.neighbours) free(hierarchy->down.neighbours);
+	}
+
+	memset(hierarchy, 0, sizeof(hierarchy_t));
+}
+
+void freeWatch(watch_t *watch)
+{
+	freeSearch(&watch->searches[0]);
+	freeSearch(&watch->searches[1]);
+	freeQueue(&watch->queues[0]);
+	freeQueue(&watch->queues[1]);
+
+	if (NULL != watch->marks) free(watch->marks);
+	if (NULL != watch->seen) free(watch->seen);
+	if (NULL != watch->answer) free(watch->answer);
+
+	memset(watch, 0, sizeof(watch_t));
 }
 
 void freeEdges(edges_t *edges)
@@ -965,6 +5959,23 @@ void freeEdges(edges_t *edges)
 		edges->count = 0; /* update meta data */
 		edges->limit = 0;
 	}
+
+	if (NULL != edges && NULL != edges->spill) /* (--external, the file is gone with it) */
+	{
+		fclose(edges->spill);
+		edges->spill = NULL;
+		edges->spilled = 0;
+	}
+
+	if (NULL != edges) freeNodeMap(&edges->nodes);
+}
+
+void freeNodeMap(nodeMap_t *nodes)
+{
+	if (NULL != nodes->slots) free(nodes->slots);
+	if (NULL != nodes->ids) free(nodes->ids);
+
+	memset(nodes, 0, sizeof(nodeMap_t));
 }
 
 void freeSaveHouses(savehouses_t *saveHouses)
@@ -0,0 +1,1380 @@
+/* Benchmarks for the solver in DS_WIn, the solver gets included so every routine can be timed on its own */
+#define main solverMain /* the solver has its own main */
+#include "../DS_WIn/loesung-581323.c"
+#undef main
+
+#include <time.h> /* timespec_get */
+
+#define DEFAULT_SIZES 2 /* 10^6 and 10^7 elements if nothing is given */
+#define SUITE_SIZES 3 /* --suite: 10^4, 10^5 and 10^6 nodes if nothing is given */
+#define MAX_REPETITIONS 1000
+#define SUITE_LOOKUPS (1 << 20) /* findNode calls per repetition */
+#define UPDATE_COUNT 1000 /* random updates per size for the update benchmark */
+#define RECOMPUTE_COUNT 5 /* full searches it gets compared to */
+#define TOPOLOGY_TREE 0 /* shapes of the suite inputs (--topology=), the same as in the AlgoDat generator */
+#define TOPOLOGY_GRID 1
+#define TOPOLOGY_RMAT 2
+#define TOPOLOGY_CHAIN 3
+#define RMAT_EDGE_FACTOR 16 /* edges per node of an rmat input (the default of the generator) */
+
+const char *topologyNames[4] = { "tree", "grid", "rmat", "chain" };
+const char *benchmarkUsage = "usage: benchmark [--threads=N] [--delta=N] [--external=DIR] [--suite [--topology=tree|grid|rmat|chain] [--warmup=N] [--repetitions=N]] [elements...]\n";
+
+double now(void); /* wall time in milliseconds */
+uint64_t nextRandom(uint64_t*); /* xorshift64*, good enough for test data */
+
+int compare_edges(const void*, const void*); /* baselines the solver does not use anymore: the qsort comparators it had */
+int compare_saveHouses(const void*, const void*);
+bool radixSortEdges(edges_t*); /* and the radix sort of all edges by start (stable) from before buildGraph did counting sorts */
+
+bool benchmarkEdgeSort(const size_t); /* qsort(compare_edges) against radixSortEdges (baselines, the solver sorts only the ids) */
+bool benchmarkSaveHouseSort(const size_t); /* qsort(compare_saveHouses) against radixSortSaveHouses */
+bool benchmarkSearch(const size_t); /* dijkstra against delta-stepping on a random graph with that many edges */
+bool benchmarkUpdates(const size_t); /* repairing a watched query after an update against searching it again */
+bool benchmarkCompression(const size_t); /* memory and dijkstra time of the blocks against --compress */
+bool benchmarkExternal(const size_t); /* building and searching in memory against --external with a quarter of the edges as budget */
+bool benchmarkExternalInput(const size_t); /* what readData holds with --external for a mapped input, against the budget */
+bool benchmarkBatch(const size_t); /* BATCH_LANES dijkstras one after the other against one batch search */
+bool buildRandomGraph(const size_t, FILE*, graph_t*); /* 4 edges per node on average, weights 1 to 1000 (sorted on disk with a spill file) */
+
+typedef struct suite_t /* everything the kernels of --suite work on, for one generated input */
+{
+	uint32_t nodes; /* size and distance mode of the generated input (like AlgoDat) */
+	uint32_t mode;
+	uint32_t topology; /* TOPOLOGY_* */
+	uint32_t warmup; /* untimed runs of every kernel */
+	uint32_t repetitions; /* timed runs */
+	FILE *input; /* the generated input */
+	edges_t edges; /* as readData gives them */
+	savehouses_t saveHouses;
+	savehouses_t sortedSaveHouses;
+	graph_t graph; /* built from those */
+	edges_t workEdges; /* what one run of a kernel works on or produces */
+	savehouses_t workSaveHouses;
+	graph_t workGraph;
+	queue_t queue;
+	search_t search;
+	uint32_t queueType; /* which queue the queue kernel uses */
+	uint32_t *keys; /* distance of every node for the queue kernel */
+	vertices_t vertices; /* the keys and visited bits the queue kernel works on */
+	uint32_t *lookups; /* ids for findNode */
+	size_t lookupCount;
+	uint64_t sink; /* results nobody needs, so nothing gets optimized away */
+} suite_t;
+
+typedef bool (*kernel_t)(suite_t*);
+
+FILE *generateInput(const uint32_t, const uint32_t, const uint32_t, uint64_t*); /* writes an input like the AlgoDat generator into a temporary file (nodes, mode, topology) */
+bool writeTree(FILE*, const uint32_t, const uint32_t, uint64_t*); /* the edges of the inputs generateInput writes */
+bool writeGrid(FILE*, const uint32_t, const uint32_t, uint64_t*);
+bool writeRmat(FILE*, const uint32_t, const uint32_t, uint64_t*);
+bool writeChain(FILE*, const uint32_t, const uint32_t, uint64_t*);
+uint64_t randomDistance(const uint32_t, const uint32_t, uint64_t*); /* weight of one edge for the distance mode */
+bool runSuite(const uint32_t, const uint32_t, const uint32_t, const uint32_t, const uint32_t); /* times every kernel on one input (nodes, mode, topology, warmup, repetitions) */
+bool timeKernel(suite_t*, const char*, kernel_t, kernel_t, const size_t); /* prepare (untimed) and run, warmup + repetitions times */
+
+int main(int argc, char **argv)
+{
+	size_t sizes[64] = { 1000000, 10000000 };
+	size_t sizeCount = 0;
+	bool suite = false;
+	uint32_t warmup = 1, repetitions = 5, topology = TOPOLOGY_TREE;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (0 == strncmp(argv[i], "--threads=", 10))
+		{
+			threadCount = (uint32_t)strtoul(argv[i] + 10, NULL, 10);
+
+			if (0 == threadCount || threadCount > MAX_THREADS)
+			{
+				fputs(benchmarkUsage, stderr);
+				return 1;
+			}
+		}
+		else if (0 == strncmp(argv[i], "--delta=", 8)) deltaValue = strtoull(argv[i] + 8, NULL, 10);
+		else if (0 == strncmp(argv[i], "--external=", 11)) externalPath = argv[i] + 11; /* where the external benchmark sorts */
+		else if (0 == strcmp(argv[i], "--suite")) suite = true; /* the sizes are node counts then */
+		else if (0 == strncmp(argv[i], "--topology=", 11))
+		{
+			for (topology = 0; topology < 4 && 0 != strcmp(argv[i] + 11, topologyNames[topology]); topology++);
+
+			if (4 == topology)
+			{
+				fputs(benchmarkUsage, stderr);
+				return 1;
+			}
+		}
+		else if (0 == strncmp(argv[i], "--warmup=", 9)) warmup = (uint32_t)strtoul(argv[i] + 9, NULL, 10);
+		else if (0 == strncmp(argv[i], "--repetitions=", 14))
+		{
+			repetitions = (uint32_t)strtoul(argv[i] + 14, NULL, 10);
+
+			if (0 == repetitions || repetitions > MAX_REPETITIONS)
+			{
+				fputs("--repetitions has to be 1 to 1000\n", stderr);
+				return 1;
+			}
+		}
+		else
+		{   /* e.g. 1000000000 for 10^9 edges, anything else is a typo (an unknown option or not a number) */
+			char *end = argv[i];
+			unsigned long long size = ('-' != argv[i][0]) ? strtoull(argv[i], &end, 10) : 0;
+
+			if (end == argv[i] || '\0' != *end || 0 == size || sizeCount >= 64)
+			{
+				fputs(benchmarkUsage, stderr);
+				return 1;
+			}
+
+			sizes[sizeCount++] = (size_t)size;
+		}
+	}
+
+	if (suite) /* every kernel on its own, for every size and distance mode */
+	{
+		if (0 == sizeCount)
+		{
+			sizes[0] = 10000;
+			sizes[1] = 100000;
+			sizes[2] = 1000000;
+			sizeCount = SUITE_SIZES;
+		}
+
+		printf("kernel,nodes,mode,topology,threads,operations,repetitions,min_ms,median_ms,mean_ms\n");
+
+		for (size_t i = 0; i < sizeCount; i++)
+		{
+			for (uint32_t mode = 0; mode < 3; mode++)
+			{
+				if (sizes[i] < 2 || sizes[i] >= MAX_ID || !runSuite((uint32_t)sizes[i], mode, topology, warmup, repetitions))
+				{
+					fprintf(stderr, "suite failed for %zu nodes, mode %"PRIu32", %s\n", sizes[i], mode, topologyNames[topology]);
+					return 1;
+				}
+			}
+		}
+
+		return 0;
+	}
+
+	if (0 == sizeCount) sizeCount = DEFAULT_SIZES;
+
+	printf("sort,elements,threads,qsort_ms,radix_ms,speedup\n");
+
+	for (size_t i = 0; i < sizeCount; i++)
+	{
+		if (!benchmarkEdgeSort(sizes[i]) || !benchmarkSaveHouseSort(sizes[i]))
+		{
+			fputs(mallocZeroException, stderr);
+			return 1;
+		}
+	}
+
+	printf("search,edges,threads,dijkstra_ms,delta_ms,speedup\n");
+
+	for (size_t i = 0; i < sizeCount; i++)
+	{
+		if (!benchmarkSearch(sizes[i]))
+		{
+			fputs(mallocZeroException, stderr);
+			return 1;
+		}
+	}
+
+	printf("update,edges,threads,updates,touched_mean,update_us,recompute_ms,speedup\n");
+
+	for (size_t i = 0; i < sizeCount; i++)
+	{
+		if (!benchmarkUpdates(sizes[i]))
+		{
+			fputs(mallocZeroException, stderr);
+			return 1;
+		}
+	}
+
+	printf("compress,edges,plain_mb,packed_mb,ratio,plain_ms,packed_ms,slowdown\n");
+
+	for (size_t i = 0; i < sizeCount; i++)
+	{
+		if (!benchmarkCompression(sizes[i]))
+		{
+			fputs(mallocZeroException, stderr);
+			return 1;
+		}
+	}
+
+	printf("batch,edges,lanes,single_ms,batched_ms,speedup\n");
+
+	for (size_t i = 0; i < sizeCount; i++)
+	{
+		if (!benchmarkBatch(sizes[i]))
+		{
+			fputs(mallocZeroException, stderr);
+			return 1;
+		}
+	}
+
+	printf("external,edges,budget_mb,plain_build_ms,external_build_ms,plain_ms,paged_ms,hit_ratio,slowdown\n");
+
+	if (NULL == externalPath) externalPath = ".";
+
+	for (size_t i = 0; i < sizeCount; i++)
+	{
+		if (!benchmarkExternal(sizes[i]))
+		{
+			fputs(externalException, stderr);
+			return 1;
+		}
+	}
+
+	printf("external_input,edges,input_mb,budget_mb,ids,buffer_mb,dictionary_mb,read_ms\n");
+
+	for (size_t i = 0; i < sizeCount; i++)
+	{
+		if (!benchmarkExternalInput(sizes[i]))
+		{
+			fputs(externalException, stderr);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+double now(void)
+{
+	struct timespec time;
+	timespec_get(&time, TIME_UTC); /* C11, so this works with msvc too */
+
+	return (double)time.tv_sec * 1000.0 + (double)time.tv_nsec / 1000000.0;
+}
+
+uint64_t nextRandom(uint64_t *state)
+{
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+
+	return *state * 0x2545F4914F6CDD1DULL;
+}
+
+int compare_edges(const void *e1, const void *e2)
+{
+	if (((edge_t*)e1)->start == ((edge_t*)e2)->start) return 0;
+	else if (((edge_t*)e1)->start < ((edge_t*)e2)->start) return -1;
+	else return 1;
+}
+
+int compare_saveHouses(const void *e1, const void *e2)
+{
+	if (*((uint32_t*)e1) == *((uint32_t*)e2)) return 0;
+	else if (*((uint32_t*)e1) < *((uint32_t*)e2)) return -1;
+	else return 1;
+}
+
+bool radixSortEdges(edges_t *edges)
+{
+	if (!radixSort((void**)&edges->data, edges->count, true)) return false;
+
+	edges->limit = edges->count; /* the buffer might have been swapped with the one of the exact size */
+
+	return true;
+}
+
+bool benchmarkEdgeSort(const size_t count)
+{
+	edges_t edges, reference;
+	uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+	memset(&edges, 0, sizeof(edges_t));
+	memset(&reference, 0, sizeof(edges_t));
+
+	edges.data = (edge_t*)malloc(sizeof(edge_t) * count);
+	reference.data = (edge_t*)malloc(sizeof(edge_t) * count);
+
+	if (NULL == edges.data || NULL == reference.data)
+	{
+		freeEdges(&edges);
+		freeEdges(&reference);
+
+		return false;
+	}
+
+	edges.count = edges.limit = reference.count = reference.limit = (uint32_t)count;
+
+	for (size_t i = 0; i < count; i++) /* ids like in the real input, below 4*10^9 */
+	{
+		edges.data[i].start = (uint32_t)(nextRandom(&state) % MAX_ID);
+		edges.data[i].end = (uint32_t)(nextRandom(&state) % MAX_ID);
+		edges.data[i].distance = nextRandom(&state) % 1000;
+	}
+
+	memcpy(reference.data, edges.data, sizeof(edge_t) * count);
+
+	double start = now();
+	qsort(reference.data, count, sizeof(edge_t), compare_edges);
+	double qsortTime = now() - start;
+
+	start = now();
+	bool sorted = radixSortEdges(&edges);
+	double radixTime = now() - start;
+
+	for (size_t i = 0; sorted && i < count; i++) /* qsort is not stable, so only the keys can be compared */
+	{
+		if (edges.data[i].start != reference.data[i].start)
+		{
+			fprintf(stderr, "edge sort differs at %zu\n", i);
+			exit(1);
+		}
+	}
+
+	printf("edges,%zu,%"PRIu32",%.1f,%.1f,%.2f\n", count, threadCount, qsortTime, radixTime, qsortTime / radixTime);
+
+	freeEdges(&edges);
+	freeEdges(&reference);
+
+	return sorted;
+}
+
+bool benchmarkSaveHouseSort(const size_t count)
+{
+	savehouses_t saveHouses, reference;
+	uint64_t state = 0xD1B54A32D192ED03ULL;
+
+	saveHouses.data = (uint32_t*)malloc(sizeof(uint32_t) * count);
+	reference.data = (uint32_t*)malloc(sizeof(uint32_t) * count);
+
+	if (NULL == saveHouses.data || NULL == reference.data)
+	{
+		freeSaveHouses(&saveHouses);
+		freeSaveHouses(&reference);
+
+		return false;
+	}
+
+	saveHouses.count = saveHouses.limit = reference.count = reference.limit = (uint32_t)count;
+
+	for (size_t i = 0; i < count; i++) saveHouses.data[i] = (uint32_t)(nextRandom(&state) % MAX_ID);
+
+	memcpy(reference.data, saveHouses.data, sizeof(uint32_t) * count);
+
+	double start = now();
+	qsort(reference.data, count, sizeof(uint32_t), compare_saveHouses);
+	double qsortTime = now() - start;
+
+	start = now();
+	bool sorted = radixSortSaveHouses(&saveHouses);
+	double radixTime = now() - start;
+
+	if (sorted && 0 != memcmp(saveHouses.data, reference.data, sizeof(uint32_t) * count))
+	{
+		fputs("savehouse sort differs\n", stderr);
+		exit(1);
+	}
+
+	printf("savehouses,%zu,%"PRIu32",%.1f,%.1f,%.2f\n", count, threadCount, qsortTime, radixTime, qsortTime / radixTime);
+
+	freeSaveHouses(&saveHouses);
+	freeSaveHouses(&reference);
+
+	return sorted;
+}
+
+bool buildRandomGraph(const size_t count, FILE *spill, graph_t *graph)
+{   /* the edges close the spill file (the graph is the same either way) */
+	edges_t edges;
+	savehouses_t saveHouses = { 0, 0, NULL };
+	uint64_t state = 0xA0761D6478BD642FULL;
+	uint32_t nodes = (uint32_t)(count / 4) + 1; /* 4 edges per node on average */
+	size_t limit = (NULL != spill) ? (size_t)(memoryBudget / (2 * sizeof(edge_t))) : count; /* like loadGraph */
+
+	memset(graph, 0, sizeof(graph_t));
+	memset(&edges, 0, sizeof(edges_t));
+	edges.spill = spill;
+	edges.data = (edge_t*)malloc(sizeof(edge_t) * (limit > 0 ? limit : 1));
+	edges.limit = (uint32_t)(limit > 0 ? limit : 1);
+
+	if (NULL == edges.data)
+	{
+		freeEdges(&edges);
+
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t startID = (uint32_t)(nextRandom(&state) % nodes);
+		uint32_t endID = (uint32_t)(nextRandom(&state) % nodes);
+
+		if (!insertEdge(&edges, startID, endID, 1 + nextRandom(&state) % 1000))
+		{
+			freeEdges(&edges);
+
+			return false;
+		}
+	}
+
+	globalStartID = globalEndID = 0;
+
+	bool built = buildGraph(&saveHouses, &edges, graph);
+
+	freeEdges(&edges);
+
+	return built;
+}
+
+bool benchmarkSearch(const size_t count)
+{
+	graph_t graph;
+
+	if (!buildRandomGraph(count, NULL, &graph))
+	{
+		freeGraph(&graph);
+
+		return false;
+	}
+
+	uint64_t limit = 100000; /* far enough to reach most of the graph */
+	search_t reference, parallel;
+
+	bool created = createSearch(&reference, &graph, &graph.out, 0, limit);
+	created = createSearch(&parallel, &graph, &graph.out, 0, limit) && created;
+
+	double start = now();
+	bool searched = created && dijkstra(&reference);
+	double dijkstraTime = now() - start;
+
+	start = now();
+	searched = searched && deltaStepping(&parallel);
+	double deltaTime = now() - start;
+
+	for (uint32_t i = 0; searched && i < graph.count; i++)
+	{
+		if (reference.vertices.distances[i] != parallel.vertices.distances[i])
+		{
+			fprintf(stderr, "delta-stepping differs at node %"PRIu32"\n", i);
+			exit(1);
+		}
+	}
+
+	printf("search,%zu,%"PRIu32",%.1f,%.1f,%.2f\n", count, threadCount, dijkstraTime, deltaTime, dijkstraTime / deltaTime);
+
+	freeSearch(&reference);
+	freeSearch(&parallel);
+	freeGraph(&graph);
+
+	return searched;
+}
+
+bool benchmarkUpdates(const size_t count)
+{   /* random weight changes, removals and new edges on a watched query, each one repaired, then the same query searched from
+	   scratch. at the end the repaired distances have to be the ones a new search finds */
+	graph_t graph;
+	watch_t watch;
+	uint64_t state = 0x9E6C63D0676A9A99ULL;
+	uint64_t limit = 100000; /* the same as benchmarkSearch */
+
+	memset(&watch, 0, sizeof(watch_t));
+
+	if (!buildRandomGraph(count, NULL, &graph) || graph.count < 2)
+	{
+		freeGraph(&graph);
+
+		return false;
+	}
+
+	for (uint32_t i = 0; i < graph.count; i += 20) SET_BIT(graph.saveHouseBits, i); /* so the answers are not empty */
+
+	uint32_t endID = graph.ids[graph.count - 1];
+
+	if (RESULT_OK != startWatch(&graph, &watch, 0, endID, limit))
+	{
+		freeGraph(&graph);
+
+		return false;
+	}
+
+	double updateTime = 0;
+	uint64_t touched = 0;
+	bool success = true;
+
+	for (uint32_t i = 0; success && i < UPDATE_COUNT; i++)
+	{
+		uint32_t from = (uint32_t)(nextRandom(&state) % graph.count);
+		uint32_t to = (uint32_t)(nextRandom(&state) % graph.count);
+		uint32_t weight = (uint32_t)(1 + nextRandom(&state) % 1000);
+		uint32_t type = UPDATE_ADD_EDGE;
+
+		if (graph.out.offsets[from] < graph.out.offsets[from + 1] && 0 != nextRandom(&state) % 3) /* mostly existing edges */
+		{
+			uint32_t edge = graph.out.offsets[from] + (uint32_t)(nextRandom(&state) % (graph.out.offsets[from + 1] - graph.out.offsets[from]));
+
+			if (EDGE_REMOVED != graph.out.neighbours[edge].distance)
+			{
+				to = graph.out.neighbours[edge].index;
+				type = (0 == nextRandom(&state) % 4) ? UPDATE_REMOVE_EDGE : UPDATE_SET_WEIGHT;
+			}
+		}
+
+		double start = now();
+		int result = updateEdges(&graph, &watch, type, from, to, (UPDATE_REMOVE_EDGE == type) ? EDGE_REMOVED : weight);
+		updateTime += now() - start;
+
+		touched += watch.touched;
+		success = (RESULT_OK == result);
+	}
+
+	savehouses_t answer = { 0, 0, NULL }, expected = { 0, 0, NULL };
+	double recomputeTime = 0;
+
+	success = success && RESULT_OK == answerWatch(&graph, &watch, &answer) && mergeAddedEdges(&graph);
+
+	for (uint32_t i = 0; success && i < RECOMPUTE_COUNT; i++)
+	{
+		freeSaveHouses(&expected);
+
+		double start = now();
+		success = (RESULT_OK == findSaveHouses(&graph, 0, endID, limit, &expected));
+		recomputeTime += now() - start;
+	}
+
+	search_t reference;
+	memset(&reference, 0, sizeof(search_t));
+
+	success = success && createSearch(&reference, &graph, &graph.out, watch.searches[0].startIndex, limit) && dijkstra(&reference);
+
+	for (uint32_t i = 0; success && i < graph.count; i++)
+	{
+		if (reference.vertices.distances[i] != watch.searches[0].vertices.distances[i])
+		{
+			fprintf(stderr, "the repaired distance differs at node %"PRIu32"\n", i);
+			exit(1);
+		}
+	}
+
+	if (success && (answer.count != expected.count || (0 != answer.count && 0 != memcmp(answer.data, expected.data, sizeof(uint32_t) * answer.count))))
+	{
+		fputs("the repaired answer differs\n", stderr);
+		exit(1);
+	}
+
+	if (success)
+	{
+		double update = updateTime * 1000.0 / UPDATE_COUNT, recompute = recomputeTime / RECOMPUTE_COUNT;
+
+		printf("update,%zu,%"PRIu32",%d,%.1f,%.1f,%.1f,%.0f\n", count, threadCount, UPDATE_COUNT, (double)touched / UPDATE_COUNT,
+			update, recompute, recompute * 1000.0 / update);
+	}
+
+	freeSearch(&reference);
+	freeSaveHouses(&answer);
+	freeSaveHouses(&expected);
+	freeWatch(&watch);
+	freeGraph(&graph);
+
+	return success;
+}
+
+FILE *generateInput(const uint32_t nodes, const uint32_t mode, const uint32_t topology, uint64_t *state)
+{   /* same shapes as the AlgoDat generator: start 0, the end is the last node (the sink for the tree), ~5% savehouses */
+	FILE *file = tmpfile(); /* a real file, so readData maps it like an input given with < */
+
+	if (NULL == file || nodes < 2)
+	{
+		if (NULL != file) fclose(file);
+
+		return NULL;
+	}
+
+	uint32_t ids = (TOPOLOGY_TREE == topology) ? nodes - 1 : nodes; /* (the tree has the nodes 0 to nodes - 2 and the sink nodes) */
+
+	fprintf(file, "0 %"PRIu32" %"PRIu32"\n", (TOPOLOGY_TREE == topology) ? nodes : nodes - 1, nodes + 1);
+
+	bool written;
+
+	switch (topology)
+	{
+	case TOPOLOGY_GRID:
+		written = writeGrid(file, nodes, mode, state);
+		break;
+	case TOPOLOGY_RMAT:
+		written = writeRmat(file, nodes, mode, state);
+		break;
+	case TOPOLOGY_CHAIN:
+		written = writeChain(file, nodes, mode, state);
+		break;
+	case TOPOLOGY_TREE:
+	default:
+		written = writeTree(file, nodes, mode, state);
+		break;
+	}
+
+	for (uint32_t i = ids; written && i-- > 0;) /* the generator writes them backwards */
+	{
+		if (nextRandom(state) % 10000 > 9500) fprintf(file, "%"PRIu32"\n", i);
+	}
+
+	if (!written || 0 != fflush(file))
+	{
+		fclose(file);
+		return NULL;
+	}
+
+	return file;
+}
+
+uint64_t randomDistance(const uint32_t nodes, const uint32_t mode, uint64_t *state)
+{   /* mode 0: everything is reachable, 1: nothing is, 2: random */
+	return (0 == mode) ? 1 : (1 == mode) ? nodes - 1 : nextRandom(state) % nodes;
+}
+
+bool writeTree(FILE *file, const uint32_t nodes, const uint32_t mode, uint64_t *state)
+{   /* a random binary tree 0..nodes-2, the leaves go to nodes */
+	uint32_t *left = (uint32_t*)malloc(sizeof(uint32_t) * nodes);
+	uint32_t *right = (uint32_t*)malloc(sizeof(uint32_t) * nodes);
+	uint32_t *stack = (uint32_t*)malloc(sizeof(uint32_t) * 2 * nodes); /* pairs parent, child */
+
+	if (NULL == left || NULL == right || NULL == stack)
+	{
+		free(left);
+		free(right);
+		free(stack);
+
+		return false;
+	}
+
+	memset(left, 0xFF, sizeof(uint32_t) * nodes); /* INFINITY32: no child */
+	memset(right, 0xFF, sizeof(uint32_t) * nodes);
+
+	for (uint32_t i = 1; i < nodes - 1; i++) /* every insert walks down randomly until there is room */
+	{
+		uint32_t node = 0;
+
+		while (1)
+		{
+			uint32_t *child = (nextRandom(state) % 10000 < 5000) ? &left[node] : &right[node];
+
+			if (INFINITY32 == *child)
+			{
+				*child = i;
+				break;
+			}
+
+			node = *child;
+		}
+	}
+
+	/* preorder like the recursive traverse(): edge to the left child, its subtree, edge to the right child, its subtree */
+	uint32_t depth = 0;
+	uint32_t node = 0;
+
+	while (1)
+	{
+		if (INFINITY32 == left[node] && INFINITY32 == right[node])
+		{
+			fprintf(file, "%"PRIu32" %"PRIu32" %"PRIu64"\n", node, nodes, randomDistance(nodes, mode, state));
+		}
+		else
+		{
+			if (INFINITY32 != right[node])
+			{
+				stack[2 * depth] = node;
+				stack[2 * depth + 1] = right[node];
+				depth++;
+			}
+
+			if (INFINITY32 != left[node])
+			{
+				stack[2 * depth] = node;
+				stack[2 * depth + 1] = left[node];
+				depth++;
+			}
+		}
+
+		if (0 == depth) break;
+
+		depth--;
+		node = stack[2 * depth + 1];
+
+		fprintf(file, "%"PRIu32" %"PRIu32" %"PRIu64"\n", stack[2 * depth], node, randomDistance(nodes, mode, state));
+	}
+
+	free(left);
+	free(right);
+	free(stack);
+
+	return true;
+}
+
+bool writeGrid(FILE *file, const uint32_t nodes, const uint32_t mode, uint64_t *state)
+{   /* the nodes row by row in a square, an edge each way to the 4 neighbours */
+	uint32_t columns = 1;
+
+	while ((uint64_t)columns * columns < nodes) columns++;
+
+	for (uint32_t i = 0; i < nodes; i++)
+	{
+		uint32_t column = i % columns;
+
+		if (column + 1 < columns && i + 1 < nodes) fprintf(file, "%"PRIu32" %"PRIu32" %"PRIu64"\n", i, i + 1, randomDistance(nodes, mode, state));
+		if (column > 0) fprintf(file, "%"PRIu32" %"PRIu32" %"PRIu64"\n", i, i - 1, randomDistance(nodes, mode, state));
+		if ((uint64_t)i + columns < nodes) fprintf(file, "%"PRIu32" %"PRIu32" %"PRIu64"\n", i, i + columns, randomDistance(nodes, mode, state));
+		if (i >= columns) fprintf(file, "%"PRIu32" %"PRIu32" %"PRIu64"\n", i, i - columns, randomDistance(nodes, mode, state));
+	}
+
+	return true;
+}
+
+bool writeRmat(FILE *file, const uint32_t nodes, const uint32_t mode, uint64_t *state)
+{   /* RMAT_EDGE_FACTOR edges per node, every level of the ids picks a quadrant with a = 0.57, b = 0.19, c = 0.19, d = 0.05 */
+	const uint64_t a = 37355, b = a + 12452, c = b + 12452;
+	uint32_t scale = 1;
+
+	while (scale < 32 && ((uint64_t)1 << scale) < nodes) scale++;
+
+	for (uint64_t edge = 0; edge < (uint64_t)nodes * RMAT_EDGE_FACTOR; edge++)
+	{
+		uint64_t from = 0, to = 0;
+
+		for (uint32_t level = 0; level < scale; level++)
+		{
+			uint64_t value = nextRandom(state) & 0xFFFF;
+
+			from = (from << 1) | (value >= b);
+			to = (to << 1) | ((value >= a && value < b) || value >= c);
+		}
+
+		fprintf(file, "%"PRIu64" %"PRIu64" %"PRIu64"\n", from % nodes, to % nodes, randomDistance(nodes, mode, state));
+	}
+
+	return true;
+}
+
+bool writeChain(FILE *file, const uint32_t nodes, const uint32_t mode, uint64_t *state)
+{   /* 0 -> 1 -> ... -> nodes - 1 */
+	for (uint32_t i = 0; i + 1 < nodes; i++) fprintf(file, "%"PRIu32" %"PRIu32" %"PRIu64"\n", i, i + 1, randomDistance(nodes, mode, state));
+
+	return true;
+}
+
+bool copyEdges(edges_t *__restrict target, edges_t *__restrict source)
+{
+	memset(&target->nodes, 0, sizeof(nodeMap_t)); /* only the edges, the sort does not need the ids */
+	target->data = (edge_t*)malloc(sizeof(edge_t) * (source->count > 0 ? source->count : 1));
+	target->count = target->limit = source->count;
+
+	if (NULL == target->data) return false;
+
+	memcpy(target->data, source->data, sizeof(edge_t) * source->count);
+
+	return true;
+}
+
+bool copySaveHouses(savehouses_t *__restrict target, savehouses_t *__restrict source)
+{
+	target->data = (uint32_t*)malloc(sizeof(uint32_t) * (source->count > 0 ? source->count : 1));
+	target->count = target->limit = source->count;
+
+	if (NULL == target->data) return false;
+
+	memcpy(target->data, source->data, sizeof(uint32_t) * source->count);
+
+	return true;
+}
+
+/* the kernels, prepare and cleanup are not timed */
+bool prepareReadData(suite_t *suite)
+{
+	memset(&suite->workEdges.nodes, 0, sizeof(nodeMap_t));
+	suite->workEdges.data = (edge_t*)malloc(sizeof(edge_t) * MEMORY_START_SIZE); /* like main() does */
+	suite->workEdges.count = 0;
+	suite->workEdges.limit = MEMORY_START_SIZE;
+	suite->workEdges.weight = INFINITY32;
+	suite->workSaveHouses.data = (uint32_t*)malloc(sizeof(uint32_t) * MEMORY_START_SIZE);
+	suite->workSaveHouses.count = 0;
+	suite->workSaveHouses.limit = MEMORY_START_SIZE;
+
+	rewind(suite->input);
+
+	return NULL != suite->workEdges.data && NULL != suite->workSaveHouses.data;
+}
+
+bool runReadData(suite_t *suite)
+{
+	return RESULT_OK == readData(suite->input, &suite->workSaveHouses, &suite->workEdges);
+}
+
+bool prepareSortIds(suite_t *suite)
+{   /* the different ids in the order readData saw them, in a savehouse list (it is the same radix sort) */
+	savehouses_t ids = { suite->edges.nodes.count, suite->edges.nodes.count, suite->edges.nodes.ids };
+
+	return copySaveHouses(&suite->workSaveHouses, &ids);
+}
+
+bool runSortIds(suite_t *suite)
+{   /* what buildGraph sorts before its counting sorts */
+	return radixSort((void**)&suite->workSaveHouses.data, suite->workSaveHouses.count, false);
+}
+
+bool prepareSortEdges(suite_t *suite)
+{
+	return copyEdges(&suite->workEdges, &suite->edges);
+}
+
+bool runSortEdges(suite_t *suite)
+{   /* baseline: the solver does not sort the edges anymore */
+	return radixSortEdges(&suite->workEdges);
+}
+
+bool prepareSortSaveHouses(suite_t *suite)
+{
+	return copySaveHouses(&suite->workSaveHouses, &suite->saveHouses);
+}
+
+bool runSortSaveHouses(suite_t *suite)
+{
+	return radixSortSaveHouses(&suite->workSaveHouses);
+}
+
+bool prepareBuildGraph(suite_t *suite)
+{   /* buildGraph takes the savehouses over, so it gets a copy (the edges it only reads) */
+	return copySaveHouses(&suite->workSaveHouses, &suite->sortedSaveHouses);
+}
+
+bool runBuildGraph(suite_t *suite)
+{
+	return buildGraph(&suite->workSaveHouses, &suite->edges, &suite->workGraph);
+}
+
+bool runBuildGraphSorted(suite_t *suite)
+{   /* with --compress (and --export) buildGraph sorts every node's neighbours, one more counting sort */
+	bool saved = compressMode;
+	compressMode = true;
+
+	bool success = runBuildGraph(suite);
+
+	compressMode = saved;
+
+	return success;
+}
+
+bool runFindNode(suite_t *suite)
+{
+	uint32_t found = 0;
+
+	for (size_t i = 0; i < suite->lookupCount; i++) found += (INFINITY32 != findNode(&suite->graph, suite->lookups[i]));
+
+	suite->sink += found; /* so the lookups can not be optimized away */
+
+	return true;
+}
+
+bool prepareQueue(suite_t *suite)
+{
+	uint32_t saved = queueType;
+	queueType = suite->queueType;
+
+	bool created = createQueue(&suite->queue, suite->graph.count, suite->graph.count);
+
+	queueType = saved;
+
+	memcpy(suite->vertices.distances, suite->keys, sizeof(uint32_t) * suite->graph.count);
+	memset(suite->vertices.visited, 0, sizeof(uint64_t) * BITMAP_WORDS(suite->graph.count));
+
+	return created;
+}
+
+bool runQueue(suite_t *suite)
+{   /* every node goes in once and comes out again */
+	for (uint32_t i = 0; i < suite->graph.count; i++)
+	{
+		if (!insertNodeToQueue(&suite->vertices, &suite->queue, i, INFINITY32)) return false;
+	}
+
+	uint32_t last = 0;
+
+	for (uint32_t i = 0; i < suite->graph.count; i++)
+	{
+		uint32_t index = removeMinNodeFromQueue(&suite->vertices, &suite->queue);
+
+		if (INFINITY32 == index || suite->vertices.distances[index] < last) return false;
+
+		SET_BIT(suite->vertices.visited, index); /* like dijkstra does */
+		last = suite->vertices.distances[index];
+	}
+
+	return INFINITY32 == removeMinNodeFromQueue(&suite->vertices, &suite->queue);
+}
+
+bool prepareDijkstraOut(suite_t *suite)
+{
+	return createSearch(&suite->search, &suite->graph, &suite->graph.out, findNode(&suite->graph, globalStartID), globalDistance);
+}
+
+bool prepareDijkstraIn(suite_t *suite)
+{
+	return createSearch(&suite->search, &suite->graph, &suite->graph.in, findNode(&suite->graph, globalEndID), globalDistance);
+}
+
+bool runDijkstra(suite_t *suite)
+{
+	return dijkstra(&suite->search);
+}
+
+bool runBreadthFirst(suite_t *suite)
+{
+	return breadthFirst(&suite->search);
+}
+
+bool runFindSaveHouses(suite_t *suite)
+{
+	return RESULT_OK == findSaveHouses(&suite->graph, globalStartID, globalEndID, globalDistance, &suite->workSaveHouses);
+}
+
+bool runBuildHierarchy(suite_t *suite)
+{   /* the hierarchy stays in the graph for findSaveHouses_hierarchy (a new build frees the old one). giving up on a grid or an
+	   rmat graph counts as a run too, the solver spends that time as well and then searches without it */
+	int result = buildHierarchy(&suite->graph);
+
+	return RESULT_OK == result || RESULT_HIERARCHY_ERR == result;
+}
+
+bool runFindSaveHousesHierarchy(suite_t *suite)
+{
+	uint32_t saved = searchType;
+	searchType = SEARCH_HIERARCHY;
+
+	bool success = runFindSaveHouses(suite);
+
+	searchType = saved;
+
+	return success;
+}
+
+void cleanupKernel(suite_t *suite)
+{   /* whatever the kernel left behind */
+	freeEdges(&suite->workEdges);
+	freeSaveHouses(&suite->workSaveHouses);
+	freeGraph(&suite->workGraph);
+	freeQueue(&suite->queue);
+	freeSearch(&suite->search);
+}
+
+int compareTimes(const void *a, const void *b)
+{
+	double first = *(const double*)a, second = *(const double*)b;
+
+	return (first > second) - (first < second);
+}
+
+bool timeKernel(suite_t *suite, const char *name, kernel_t prepare, kernel_t run, const size_t operations)
+{   /* warmup runs first, then the repetitions, prints one csv line */
+	double times[MAX_REPETITIONS];
+
+	for (uint32_t i = 0; i < suite->warmup + suite->repetitions; i++)
+	{
+		if (NULL != prepare && !prepare(suite))
+		{
+			cleanupKernel(suite);
+			return false;
+		}
+
+		double start = now();
+		bool success = run(suite);
+		double time = now() - start;
+
+		cleanupKernel(suite);
+
+		if (!success)
+		{
+			fprintf(stderr, "%s failed\n", name);
+			return false;
+		}
+
+		if (i >= suite->warmup) times[i - suite->warmup] = time;
+	}
+
+	qsort(times, suite->repetitions, sizeof(double), compareTimes);
+
+	double sum = 0;
+	for (uint32_t i = 0; i < suite->repetitions; i++) sum += times[i];
+
+	printf("%s,%"PRIu32",%"PRIu32",%s,%"PRIu32",%zu,%"PRIu32",%.3f,%.3f,%.3f\n", name, suite->nodes, suite->mode, topologyNames[suite->topology], threadCount, operations,
+		suite->repetitions, times[0], times[suite->repetitions / 2], sum / suite->repetitions);
+	fflush(stdout);
+
+	return true;
+}
+
+bool runSuite(const uint32_t nodes, const uint32_t mode, const uint32_t topology, const uint32_t warmup, const uint32_t repetitions)
+{   /* one generated input, every kernel on it */
+	suite_t suite;
+	memset(&suite, 0, sizeof(suite));
+
+	suite.nodes = nodes;
+	suite.mode = mode;
+	suite.topology = topology;
+	suite.warmup = warmup;
+	suite.repetitions = repetitions;
+
+	uint64_t state = 0x853C49E6748FEA9BULL + nodes * 3 + mode; /* every size and mode gets its own (fixed) graph */
+
+	suite.input = generateInput(nodes, mode, topology, &state);
+
+	if (NULL == suite.input) return false;
+
+	/* the inputs of the later kernels are made by the earlier ones, but outside of the timing */
+	bool success = prepareReadData(&suite) && runReadData(&suite);
+
+	suite.edges = suite.workEdges;
+	suite.saveHouses = suite.workSaveHouses;
+	memset(&suite.workEdges, 0, sizeof(edges_t));
+	memset(&suite.workSaveHouses, 0, sizeof(savehouses_t));
+
+	success = success && copySaveHouses(&suite.sortedSaveHouses, &suite.saveHouses) && radixSortSaveHouses(&suite.sortedSaveHouses);
+	success = success && prepareBuildGraph(&suite) && runBuildGraph(&suite);
+
+	suite.graph = suite.workGraph;
+	memset(&suite.workGraph, 0, sizeof(graph_t));
+	freeSaveHouses(&suite.workSaveHouses);
+
+	if (success)
+	{
+		suite.lookupCount = SUITE_LOOKUPS;
+		suite.lookups = (uint32_t*)malloc(sizeof(uint32_t) * suite.lookupCount);
+		suite.keys = (uint32_t*)malloc(sizeof(uint32_t) * suite.graph.count);
+		suite.vertices.distances = (uint32_t*)malloc(sizeof(uint32_t) * suite.graph.count);
+		suite.vertices.visited = (uint64_t*)malloc(sizeof(uint64_t) * BITMAP_WORDS(suite.graph.count));
+
+		success = (NULL != suite.lookups && NULL != suite.keys && NULL != suite.vertices.distances && NULL != suite.vertices.visited);
+	}
+
+	if (success)
+	{
+		for (size_t i = 0; i < suite.lookupCount; i++) /* half of them hit */
+		{
+			uint32_t random = (uint32_t)nextRandom(&state);
+			suite.lookups[i] = (random & 1) ? suite.graph.ids[random % suite.graph.count] : (random >> 1) % MAX_ID;
+		}
+
+		for (uint32_t i = 0; i < suite.graph.count; i++) suite.keys[i] = (uint32_t)(nextRandom(&state) % suite.graph.count);
+
+		uint32_t queueTypes[3] = { QUEUE_BINARY, QUEUE_RADIX, QUEUE_BUCKET };
+		const char *queueNames[3] = { "queue_binary", "queue_radix", "queue_bucket" };
+
+		success = timeKernel(&suite, "readData", prepareReadData, runReadData, suite.edges.count) &&
+			timeKernel(&suite, "sortIds", prepareSortIds, runSortIds, suite.edges.nodes.count) &&
+			timeKernel(&suite, "radixSortSaveHouses", prepareSortSaveHouses, runSortSaveHouses, suite.saveHouses.count) &&
+			timeKernel(&suite, "buildGraph", prepareBuildGraph, runBuildGraph, suite.edges.count) &&
+			timeKernel(&suite, "buildGraph_sorted", prepareBuildGraph, runBuildGraphSorted, suite.edges.count) &&
+			timeKernel(&suite, "baseline_radixSortEdges", prepareSortEdges, runSortEdges, suite.edges.count) &&
+			timeKernel(&suite, "findNode", NULL, runFindNode, suite.lookupCount);
+
+		for (uint32_t i = 0; success && i < 3; i++)
+		{
+			suite.queueType = queueTypes[i];
+			success = timeKernel(&suite, queueNames[i], prepareQueue, runQueue, (size_t)suite.graph.count * 2);
+		}
+
+		success = success && timeKernel(&suite, "dijkstra_out", prepareDijkstraOut, runDijkstra, suite.graph.out.count) &&
+			timeKernel(&suite, "dijkstra_in", prepareDijkstraIn, runDijkstra, suite.graph.in.count);
+
+		if (WEIGHTS_MIXED != suite.graph.hopWeight) /* (distance modes 0 and 1, findSaveHouses counts hops there as well) */
+		{
+			success = success && timeKernel(&suite, "bfs_out", prepareDijkstraOut, runBreadthFirst, suite.graph.out.count) &&
+				timeKernel(&suite, "bfs_in", prepareDijkstraIn, runBreadthFirst, suite.graph.in.count);
+		}
+
+		success = success &&
+			timeKernel(&suite, "findSaveHouses", NULL, runFindSaveHouses, suite.graph.out.count) &&
+			timeKernel(&suite, "buildHierarchy", NULL, runBuildHierarchy, suite.graph.out.count) &&
+			timeKernel(&suite, "findSaveHouses_hierarchy", NULL, runFindSaveHousesHierarchy, suite.graph.out.count);
+	}
+
+	fclose(suite.input);
+	free(suite.lookups);
+	free(suite.keys);
+	free(suite.vertices.distances);
+	free(suite.vertices.visited);
+	freeEdges(&suite.edges);
+	freeSaveHouses(&suite.saveHouses);
+	freeSaveHouses(&suite.sortedSaveHouses);
+	freeGraph(&suite.graph);
+
+	return success;
+}
+
+bool benchmarkCompression(const size_t count)
+{   /* both directions, like findSaveHouses needs them. the packed searches have to find the same distances */
+	graph_t graph;
+
+	if (!buildRandomGraph(count, NULL, &graph))
+	{
+		freeGraph(&graph);
+
+		return false;
+	}
+
+	uint64_t limit = 100000; /* the same as benchmarkSearch */
+	double plainTime = 0, packedTime = 0;
+	search_t plain[2], packed[2];
+
+	memset(plain, 0, sizeof(plain));
+	memset(packed, 0, sizeof(packed));
+
+	size_t plainBytes = 2 * (sizeof(uint32_t) * ((size_t)graph.count + 1) + sizeof(neighbour_t) * (size_t)graph.out.count);
+
+	bool success = createSearch(&plain[0], &graph, &graph.out, 0, limit) && createSearch(&plain[1], &graph, &graph.in, 0, limit);
+
+	for (uint32_t i = 0; success && i < 2; i++)
+	{
+		double start = now();
+		success = dijkstra(&plain[i]);
+		plainTime += now() - start;
+	}
+
+	success = success && compressGraph(&graph);
+
+	size_t packedBytes = 2 * (sizeof(uint64_t) * (((size_t)graph.count >> PACKED_BLOCK_BITS) + 1) + sizeof(uint32_t) * (size_t)graph.count + PACKED_PADDING) +
+		graph.out.packedSize + graph.in.packedSize;
+
+	success = success && createSearch(&packed[0], &graph, &graph.out, 0, limit) && createSearch(&packed[1], &graph, &graph.in, 0, limit);
+
+	for (uint32_t i = 0; success && i < 2; i++)
+	{
+		double start = now();
+		success = dijkstra(&packed[i]);
+		packedTime += now() - start;
+	}
+
+	for (uint32_t i = 0; success && i < 2; i++)
+	{
+		if (0 != memcmp(plain[i].vertices.distances, packed[i].vertices.distances, sizeof(uint32_t) * graph.count))
+		{
+			fputs("the packed search differs\n", stderr);
+			exit(1);
+		}
+	}
+
+	if (success)
+	{
+		printf("compress,%zu,%.1f,%.1f,%.2f,%.1f,%.1f,%.2f\n", count, plainBytes / 1048576.0, packedBytes / 1048576.0,
+			(double)plainBytes / (double)packedBytes, plainTime, packedTime, packedTime / plainTime);
+	}
+
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		freeSearch(&plain[i]);
+		freeSearch(&packed[i]);
+	}
+
+	freeGraph(&graph);
+
+	return success;
+}
+
+bool benchmarkExternal(const size_t count)
+{   /* both directions, like findSaveHouses needs them. the budget keeps a quarter of the neighbours in the frames and makes
+	   the sort write several runs, the paged searches have to find the same distances */
+	graph_t plain, paged;
+	uint64_t limit = 100000; /* the same as benchmarkSearch */
+	double plainTime = 0, pagedTime = 0;
+	search_t searches[4];
+
+	memset(&paged, 0, sizeof(graph_t));
+	memset(searches, 0, sizeof(searches));
+	memoryBudget = sizeof(edge_t) * (uint64_t)count / 4;
+	if (memoryBudget < ((uint64_t)1 << 20)) memoryBudget = (uint64_t)1 << 20;
+
+	double start = now();
+	bool success = buildRandomGraph(count, NULL, &plain);
+	double plainBuild = now() - start;
+
+	FILE *spill = success ? openScratch() : NULL;
+
+	start = now();
+	success = success && NULL != spill && buildRandomGraph(count, spill, &paged);
+	double externalBuild = now() - start;
+
+	for (uint32_t i = 0; success && i < 2; i++)
+	{
+		success = createSearch(&searches[i], &plain, (0 == i) ? &plain.out : &plain.in, 0, limit) &&
+			createSearch(&searches[2 + i], &paged, (0 == i) ? &paged.out : &paged.in, 0, limit);
+
+		start = now();
+		success = success && dijkstra(&searches[i]);
+		plainTime += now() - start;
+
+		start = now();
+		success = success && dijkstra(&searches[2 + i]);
+		pagedTime += now() - start;
+
+		if (success && 0 != memcmp(searches[i].vertices.distances, searches[2 + i].vertices.distances, sizeof(uint32_t) * plain.count))
+		{
+			fputs("the paged search differs\n", stderr);
+			exit(1);
+		}
+	}
+
+	if (success)
+	{
+		uint64_t requests = 0, reads = 0;
+
+		for (uint32_t i = 0; i < 2; i++) /* (a graph without edges has no pager) */
+		{
+			pager_t *pager = (0 == i) ? paged.out.pager : paged.in.pager;
+
+			if (NULL != pager)
+			{
+				requests += pager->requests;
+				reads += pager->reads;
+			}
+		}
+
+		printf("external,%zu,%.1f,%.1f,%.1f,%.1f,%.1f,%.3f,%.2f\n", count, memoryBudget / 1048576.0, plainBuild, externalBuild, plainTime, pagedTime,
+			(requests > 0) ? 1.0 - (double)reads / (double)requests : 1.0, pagedTime / plainTime);
+	}
+
+	for (uint32_t i = 0; i < 4; i++) freeSearch(&searches[i]);
+
+	freeGraph(&plain);
+	freeGraph(&paged);
+
+	return success;
+}
+
+bool benchmarkExternalInput(const size_t count)
+{   /* a text input in a real file (so it gets mapped) with count edges between count / 64 ids and the budget of benchmarkExternal.
+	   besides the edge buffer the reader may only hold the dictionary those ids need (at most 4 slots per id after growing),
+	   however big the file is */
+	uint64_t state = 0xD1B54A32D192ED03ULL;
+	uint32_t ids = (count / 64 > 2) ? (uint32_t)(count / 64) : 2;
+	FILE *file = tmpfile();
+
+	memoryBudget = sizeof(edge_t) * (uint64_t)count / 4;
+	if (memoryBudget < ((uint64_t)1 << 20)) memoryBudget = (uint64_t)1 << 20;
+
+	if (NULL == file) return false;
+
+	fprintf(file, "1 2 %"PRIu64"\n", (uint64_t)100000);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		fprintf(file, "%"PRIu64" %"PRIu64" %"PRIu64"\n", 1 + nextRandom(&state) % ids, 1 + nextRandom(&state) % ids, 1 + nextRandom(&state) % 1000);
+	}
+
+	fprintf(file, "%"PRIu32"\n", ids);
+
+	long inputSize = ftell(file);
+
+	if (0 != fflush(file) || 0 != fseek(file, 0, SEEK_SET))
+	{
+		fclose(file);
+
+		return false;
+	}
+
+	edges_t edges;
+	savehouses_t saveHouses;
+
+	memset(&edges, 0, sizeof(edges_t)); /* like loadGraph with --external */
+	edges.limit = (uint32_t)(memoryBudget / (2 * sizeof(edge_t)));
+	edges.weight = INFINITY32;
+	edges.data = (edge_t*)malloc(sizeof(edge_t) * edges.limit);
+	edges.spill = openScratch();
+
+	saveHouses.data = (uint32_t*)malloc(sizeof(uint32_t) * MEMORY_START_SIZE);
+	saveHouses.count = 0;
+	saveHouses.limit = MEMORY_START_SIZE;
+
+	double start = now();
+	bool success = NULL != edges.data && NULL != edges.spill && NULL != saveHouses.data && RESULT_OK == readData(file, &saveHouses, &edges);
+	double readTime = now() - start;
+
+	fclose(file);
+
+	if (success)
+	{
+		size_t buffer = sizeof(edge_t) * edges.limit;
+		size_t dictionary = sizeof(nodeSlot_t) * edges.nodes.capacity + sizeof(uint32_t) * (edges.nodes.capacity >> 1);
+		size_t needed = (size_t)4 * (edges.nodes.count > (1 << NODE_MAP_START_BITS) ? edges.nodes.count : (1 << NODE_MAP_START_BITS));
+
+		if (edges.nodes.capacity > needed)
+		{
+			fputs("the dictionary is bigger than its ids need\n", stderr);
+			exit(1);
+		}
+
+		printf("external_input,%zu,%.1f,%.1f,%"PRIu32",%.1f,%.1f,%.1f\n", count, inputSize / 1048576.0, memoryBudget / 1048576.0, edges.nodes.count,
+			buffer / 1048576.0, dictionary / 1048576.0, readTime);
+	}
+
+	freeSaveHouses(&saveHouses);
+	freeEdges(&edges);
+
+	return success;
+}
+
+bool benchmarkBatch(const size_t count)
+{   /* random starts with limits from a tenth of benchmarkSearch up to all of it, every lane has to find the distances of its dijkstra
+	   (both sides pay for their allocations) */
+	graph_t graph;
+
+	if (!buildRandomGraph(count, NULL, &graph))
+	{
+		freeGraph(&graph);
+
+		return false;
+	}
+
+	uint64_t state = 0x94D049BB133111EBULL;
+	uint32_t starts[BATCH_LANES], limits[BATCH_LANES];
+
+	for (uint32_t i = 0; i < BATCH_LANES; i++)
+	{
+		starts[i] = (uint32_t)(nextRandom(&state) % graph.count);
+		limits[i] = 10000 + (uint32_t)(nextRandom(&state) % 90001);
+	}
+
+	batch_t batch;
+	double start = now();
+	bool success = createBatch(&batch, &graph, &graph.out);
+
+	for (uint32_t i = 0; success && i < BATCH_LANES; i++)
+	{
+		batch.starts[i] = starts[i];
+		batch.limits[i] = limits[i];
+	}
+
+	success = success && batchSearch(&batch);
+	double batchTime = now() - start;
+	double singleTime = 0;
+
+	for (uint32_t i = 0; success && i < BATCH_LANES; i++)
+	{
+		search_t search;
+
+		start = now();
+		success = createSearch(&search, &graph, &graph.out, starts[i], limits[i]) && dijkstra(&search);
+		singleTime += now() - start;
+
+		for (uint32_t j = 0; success && j < graph.count; j++)
+		{
+			if (search.vertices.distances[j] != batch.lanes[(size_t)j * BATCH_LANES + i])
+			{
+				fprintf(stderr, "lane %"PRIu32" of the batch differs at node %"PRIu32"\n", i, j);
+				exit(1);
+			}
+		}
+
+		freeSearch(&search);
+	}
+
+	if (success) printf("batch,%zu,%d,%.1f,%.1f,%.2f\n", count, BATCH_LANES, singleTime, batchTime, singleTime / batchTime);
+
+	freeBatch(&batch);
+	freeGraph(&graph);
+
+	return success;
+}